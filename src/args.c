@@ -7,6 +7,7 @@
 #include "common.h"
 #include "fileutil.h"
 #include "memory.h"
+#include "stats.h"
 
 // ===== PRIVATE FUNCTION DECLARATIONS =====
 
@@ -26,6 +27,14 @@ static int _args_is_v(const int argc, const char **argv);
 // Return 1 if was, 0 if wasnt.
 static int _args_is_i(const int argc, const char **argv);
 
+// Using ARGS find if single-pass flag was set to true.
+// Return 1 if was, 0 if wasnt.
+static int _args_is_s(const int argc, const char **argv);
+
+// Using ARGS find if statistics were requested by --stats or --stats=json.
+// Return the requested format, STATS_OFF if none.
+static enum Stats_Format _args_stats(const int argc, const char **argv);
+
 // Change extension from '.kas' to '.kmx'.
 // Return 1 on success, 0 on failure.
 static int _args_change_extension(char *path);
@@ -38,7 +47,9 @@ enum Err_Main args_parse(struct Config *config, const int argc,
   int v = 0, i = 0, tgt_edit = 0;
 
   if (argc < 2 || !argv || !config) { // Never could happen config == NULL
-    printf("Usage: ./kmas.exe <source.kas> [target.kmx] [-v] [-i]\n");
+    log_message(LOG_ERROR,
+                "Usage: ./kmas.exe <source.kas> [target.kmx] [-v] [-i] [-s] "
+                "[--stats[=json]]\n");
     return ERR_INVALID_INPUT_FILE;
   }
 
@@ -58,6 +69,8 @@ enum Err_Main args_parse(struct Config *config, const int argc,
     args_config_deinit(config);
     return ERR_INVALID_INPUT_FILE;
   }
+  config->flag_single_pass = _args_is_s(argc, argv);
+  config->flag_stats = _args_stats(argc, argv);
 
   if (tgt_edit) { // target didnt exist, now must exit extension
     if (!_args_change_extension(config->target)) {
@@ -171,6 +184,8 @@ void args_config_deinit(struct Config *config) {
   CLEANUP_IF_FAIL(config);
   config->flag_verbose = 0;
   config->flag_instruction = 0;
+  config->flag_single_pass = 0;
+  config->flag_stats = STATS_OFF;
 
   jree_clear((void **)&config->source);
   jree_clear((void **)&config->target);
@@ -232,6 +247,37 @@ cleanup:
   return 0;
 }
 
+static int _args_is_s(const int argc, const char **argv) {
+  int i = 0;
+  CLEANUP_IF_FAIL(argc > 2 && argv);
+
+  for (i = 2; i < argc; i++) { // skip .exe and src argumnets
+    if (strcmp(argv[i], "-s") == 0) {
+      return 1;
+    }
+  }
+
+cleanup:
+  return 0;
+}
+
+static enum Stats_Format _args_stats(const int argc, const char **argv) {
+  int i = 0;
+  CLEANUP_IF_FAIL(argc > 2 && argv);
+
+  for (i = 2; i < argc; i++) { // skip .exe and src argumnets
+    if (strcmp(argv[i], "--stats") == 0) {
+      return STATS_TEXT;
+    }
+    if (strcmp(argv[i], "--stats=json") == 0) {
+      return STATS_JSON;
+    }
+  }
+
+cleanup:
+  return STATS_OFF;
+}
+
 static int _args_change_extension(char *path) {
   char *begin = NULL;
   if (!path) {
@@ -1,6 +1,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "assembler.h"
 #include "codeseg.h"
@@ -12,6 +13,8 @@
 #include "memory.h"
 #include "parser.h"
 #include "parser_data.h"
+#include "program.h"
+#include "stats.h"
 #include "symbol.h"
 
 // If condition fail, set variable 'err' to given er
@@ -33,12 +36,38 @@
     }                                                                          \
   } while (0)
 
+// Is verbose output on? Constant 0 in a build without verbose output, so the
+// PRINT_VERBOSE* calls are removed entirely.
+#define VERBOSE_ON                                                             \
+  (VERBOSE_BUILD && asp && asp->config && asp->config->flag_verbose)
 #define PRINT_VERBOSE(...)                                                     \
-  print_verbose(asp && asp->config && asp->config->flag_verbose, __VA_ARGS__)
+  do {                                                                         \
+    if (VERBOSE_ON)                                                            \
+      print_verbose(1, __VA_ARGS__);                                           \
+  } while (0)
 #define PRINT_VERBOSE_CLN(...)                                                 \
-  print_verbose_clean(asp && asp->config && asp->config->flag_verbose,         \
-                      __VA_ARGS__)
-#define PRINT_VERBOSE_DBG(...) print_verbose(DEBUG, __VA_ARGS__)
+  do {                                                                         \
+    if (VERBOSE_ON)                                                            \
+      print_verbose_clean(1, __VA_ARGS__);                                     \
+  } while (0)
+#define PRINT_VERBOSE_DBG(...)                                                 \
+  print_verbose(VERBOSE_BUILD && DEBUG, __VA_ARGS__)
+
+// Is --stats on? Only then the phases are timed and lines counted.
+#define STATS_ON                                                               \
+  (asp && asp->config && asp->config->flag_stats != STATS_OFF)
+// Start timing from now into local variable t, only with --stats.
+#define STATS_START()                                                          \
+  do {                                                                         \
+    if (STATS_ON)                                                              \
+      t = stats_now();                                                         \
+  } while (0)
+// Add the time since t to phase and restart t, only with --stats.
+#define STATS_LAP(phase)                                                       \
+  do {                                                                         \
+    if (STATS_ON)                                                              \
+      t = stats_lap(&asp->stats, (phase), t);                                  \
+  } while (0)
 
 // If condition fail, print verbose clean & return err.
 #define RET_VERBOSE_CLN_IF_FAIL(cond, err, ...)                                \
@@ -56,42 +85,14 @@
 // Given any ASM error, convert it to corresponding MAIN error.
 static enum Err_Main _err_convert(enum Err_Asm err);
 
-// I accidentally created a continuous array of tokens in lexer but require
-// array of pointers to tokens in parser. This function is a bridge between
-// these differences. Caller must free this "convertor" after is used. Return
-// NULL on failure, pointer on success.
-static const struct Token **_convert_tokens(const struct Token *orig);
-
-// Free the array of pointers to tokens & set the pointer to null.
-// It frees only the array, not the tokens = can have const ptr.
-static void _free_tokens_convertor(const struct Token **tokens[]);
-
-// Convert the structure given from lexer (struct Token *) to that wanted in
-// parser (struct Token **). Free that structure on return. Otherwise only a
-// wrapper around parse_tokens in parser.
-static struct Parsed_Statement *_parse_tokens(const struct Token *tokens,
-                                              size_t nl);
-
-// === SHARED LOGIC ===
-
-// Pass 1 & 2 holds many similarities, therefore this function to have the
-// shared logic. Calls different functions based on the pass.
-static enum Err_Asm _pass(struct Assembler_Processing *asp, int is_second);
-
-// Pass 1 & 2 have very similiar behaviour on one line.
-// This function have the common logic & calls adequate functions based on
-// is_second.
-static enum Err_Asm _pass_line(struct Assembler_Processing *asp,
-                               enum Assembler_Context *ctx, size_t nl,
-                               const char *line, int is_second);
-
 // === PASS 1 ===
 
-// Process one line in the first pass of the assembler code.
+// Process one line in the first pass of the assembler code: tokenize, parse,
+// evaluate and remember the statement for the second pass.
 // Return adequate error code, edit context if changed.
 static enum Err_Asm _pass1_line(struct Assembler_Processing *asp,
-                                enum Assembler_Context *ctx, size_t nl,
-                                const char *line);
+                                enum Assembler_Context *ctx,
+                                const struct Fu_Line *line);
 
 // Decide what to do in pass1 with given pstmt in pass one.
 static enum Err_Asm _pass1_decide(struct Parsed_Statement *pstmt,
@@ -113,6 +114,25 @@ static enum Err_Asm _pass1_data_decl(struct Parsed_Statement *pstmt,
                                      struct Assembler_Processing *asp,
                                      enum Assembler_Context *ctx, size_t nl);
 
+// Append all segments of data declaration into data segment.
+static enum Err_Asm _pass1_data_emit(const struct Data_Declaration *dd,
+                                     struct Assembler_Processing *asp);
+
+static enum Err_Asm _pass1_data_decl_uninit(struct Assembler_Processing *asp,
+                                            const struct Init_Segment *is,
+                                            enum Data_Type dt);
+
+static enum Err_Asm _pass1_data_decl_value(struct Assembler_Processing *asp,
+                                           const struct Init_Segment *is,
+                                           enum Data_Type dt);
+
+static enum Err_Asm _pass1_data_decl_string(struct Assembler_Processing *asp,
+                                            const struct Init_Segment *is);
+
+static enum Err_Asm _pass1_data_decl_dup(struct Assembler_Processing *asp,
+                                         const struct Init_Segment *is,
+                                         enum Data_Type dt);
+
 static enum Err_Asm _pass1_instruction(struct Parsed_Statement *pstmt,
                                        struct Assembler_Processing *asp,
                                        enum Assembler_Context *ctx, size_t nl);
@@ -121,51 +141,78 @@ static enum Err_Asm _pass1_label_def(struct Parsed_Statement *pstmt,
                                      struct Assembler_Processing *asp,
                                      enum Assembler_Context *ctx, size_t nl);
 
+// Define symbol of given id, interned by the lexer as SYM_UNKNOWN placeholder
+// (see _operand_value), in place as given kind. Set *defined to 0 if the
+// symbol was already defined. Return the symbol, NULL on failure.
+static struct Symbol *_pass1_define_symbol(struct Assembler_Processing *asp,
+                                           uint32_t id, size_t address,
+                                           enum Symbol_Kind kind,
+                                           int *defined);
+
+// Count the line with its tokens & statement into asp->stats.
+static void _pass1_count_line(struct Assembler_Processing *asp,
+                              const struct Token *tokens,
+                              const struct Parsed_Statement *pstmt);
+
+// Return how many symbols are defined, without placeholders of references.
+static size_t _pass1_count_defined(const struct Assembler_Processing *asp);
+
+// Patch imm32 of all fixups by addresses of their symbols, single-pass only.
+// Every symbol still not defined is reported. Return adequate error code.
+static enum Err_Asm _pass1_resolve_fixups(struct Assembler_Processing *asp);
+
 static enum Err_Asm _pass1_none(struct Assembler_Processing *asp, size_t nl);
 
 static enum Err_Asm _pass1_error(struct Assembler_Processing *asp, size_t nl);
 
-static enum Err_Asm _pass2_line(struct Assembler_Processing *asp,
-                                enum Assembler_Context *ctx, size_t nl,
-                                const char *line);
-
 // === PASS 2 ===
 
-static enum Err_Asm _pass2_decide(struct Parsed_Statement *pstmt,
-                                  struct Assembler_Processing *asp,
-                                  enum Assembler_Context *ctx, size_t nl);
+static enum Err_Asm _pass2_instruction(const struct Program_Statement *stmt,
+                                       struct Assembler_Processing *asp);
 
-static enum Err_Asm _pass2_data_decl(struct Parsed_Statement *pstmt,
-                                     struct Assembler_Processing *asp,
-                                     enum Assembler_Context *ctx, size_t nl);
+// === BOTH PASSES ===
 
-static enum Err_Asm _pass2_instruction(struct Parsed_Statement *pstmt,
-                                       struct Assembler_Processing *asp,
-                                       enum Assembler_Context *ctx, size_t nl);
+// Encode instruction into out, which has its encoded size and lies on position
+// in code segment. Return adequate error code.
+static enum Err_Asm _encode_instruction(struct Assembler_Processing *asp,
+                                        const struct Instruction_Statement *is,
+                                        uint8_t *out, size_t position,
+                                        size_t line);
 
-static enum Err_Asm _pass2_data_decl_uninit(struct Assembler_Processing *asp,
-                                            const struct Init_Segment *is);
+// Get value of imm32 operand: the number itself, or address of label/offset
+// from symbol table. In single-pass mode the symbol not defined yet gets a
+// fixup for code_offset and value 0. Return adequate error code.
+static enum Err_Asm _operand_value(struct Assembler_Processing *asp,
+                                   const struct Operand *op,
+                                   size_t code_offset, size_t line,
+                                   uint32_t *value);
 
-static enum Err_Asm _pass2_data_decl_value(struct Assembler_Processing *asp,
-                                           const struct Init_Segment *is,
-                                           enum Data_Type dt);
+// Remember a fixup, growing the list if needed.
+// Return 1 on success, 0 on failure.
+static int _app_fixup(struct Assembler_Processing *asp, size_t code_offset,
+                      size_t symbol_id, size_t line, enum Symbol_Kind kind);
 
-static enum Err_Asm _pass2_data_decl_string(struct Assembler_Processing *asp,
-                                            const struct Init_Segment *is);
+// Store 32 bit value to dst in little endian.
+static void _store_le32(uint8_t *dst, uint32_t value);
 
-static enum Err_Asm _pass2_data_decl_dup(struct Assembler_Processing *asp,
-                                         const struct Init_Segment *is,
-                                         enum Data_Type dt);
 
 // ===== HEADER DEFINITIONS =====
 
 enum Err_Main process_assembler(struct Assembler_Processing *asp) {
   enum Err_Asm res = ASM_NO_ERROR;
+  uint64_t t = 0;
   if ((res = pass1(asp)) != ASM_NO_ERROR) {
     return _err_convert(res);
   }
-  cdsg_begin(asp->cdsg); // reuse segments
-  dtsg_begin(asp->dtsg); // goto start
+  if (asp->config && asp->config->flag_single_pass) {
+    STATS_START();
+    res = _pass1_resolve_fixups(asp); // code is encoded
+    STATS_LAP(STATS_FIXUPS);
+    return _err_convert(res);
+  }
+  if (!cdsg_begin(asp->cdsg)) { // reuse code segment, data are emitted
+    return ERR_OUT_OF_MEMORY;
+  }
   if ((res = pass2(asp)) != ASM_NO_ERROR) {
     return _err_convert(res);
   }
@@ -173,9 +220,58 @@ enum Err_Main process_assembler(struct Assembler_Processing *asp) {
   return ERR_NO_ERROR;
 }
 
-enum Err_Asm pass1(struct Assembler_Processing *asp) { return _pass(asp, 0); }
+enum Err_Asm pass1(struct Assembler_Processing *asp) {
+  enum Assembler_Context ctx = ASC_FILE_START;
+  struct Fu_Line line = {0};
+  struct Jarena_Mark mark = {0};
+  uint64_t t = 0;
+  enum Err_Asm err = ASM_NO_ERROR;
+  RETURN_IF_FAIL(asp && asp->config && asp->program, ASM_INVALID_ARGS);
+  PRINT_VERBOSE("STARTING PASS 1\n");
+  jarena_mark(&asp->arena, &mark);
+
+  if (!asp->source) { // read only once
+    STATS_START();
+    asp->source = fu_source_create(asp->config->source);
+    STATS_LAP(STATS_READ);
+  }
+  RET_VERBOSE_CLN_IF_FAIL(asp->source, ASM_CANNOT_OPEN_FILE,
+                          "Couldn't open file: %s\n", asp->config->source);
+  prog_clear(asp->program);
+
+  while (fu_source_next_line(asp->source, &line)) {
+    REUSE_ERR_IF_FAIL(_pass1_line(asp, &ctx, &line));
+  }
+
+  if (STATS_ON) { // both segments & symbols are complete after 1st pass
+    asp->stats.source_bytes = asp->source->size;
+    asp->stats.symbols = _pass1_count_defined(asp);
+    asp->stats.code_bytes = cdsg_get_size(asp->cdsg);
+    asp->stats.data_bytes = dtsg_get_size(asp->dtsg);
+  }
+
+cleanup:
+  jarena_reset(&asp->arena, &mark); // nothing of the pass outlives it
+  return err;
+}
+
+enum Err_Asm pass2(struct Assembler_Processing *asp) {
+  size_t i = 0, count = 0;
+  uint64_t t = 0;
+  enum Err_Asm err = ASM_NO_ERROR;
+  RETURN_IF_FAIL(asp && asp->program, ASM_INVALID_ARGS);
+  PRINT_VERBOSE("STARTING PASS 2\n");
+  STATS_START();
+
+  count = prog_get_count(asp->program);
+  for (i = 0; i < count; i++) {
+    REUSE_ERR_IF_FAIL(_pass2_instruction(prog_get(asp->program, i), asp));
+  }
 
-enum Err_Asm pass2(struct Assembler_Processing *asp) { return _pass(asp, 1); }
+cleanup:
+  STATS_LAP(STATS_ENCODE);
+  return err;
+}
 
 struct Assembler_Processing *asp_create(const struct Config *config,
                                         struct Symbol_Table *symtab,
@@ -200,6 +296,12 @@ int asp_init(struct Assembler_Processing *asp, const struct Config *config,
     return 0;
   }
   asp->config = config;
+  asp->bss_size = 0;
+  asp->fixups = NULL;
+  asp->fixup_count = 0;
+  asp->fixup_capacity = 0;
+  memset(&asp->stats, 0, sizeof(asp->stats));
+  CLEANUP_IF_FAIL(jarena_init(&asp->arena, 0));
 
   if (symtab) {
     asp->symtab = symtab;
@@ -212,6 +314,8 @@ int asp_init(struct Assembler_Processing *asp, const struct Config *config,
     asp->dtsg = dtsg;
   } else {
     asp->dtsg = dtsg_create();
+    // large uninitialized & DUP data are kept as runs until output
+    CLEANUP_IF_FAIL(dtsg_use_extents(asp->dtsg));
   }
   CLEANUP_IF_FAIL(asp->dtsg);
 
@@ -222,6 +326,9 @@ int asp_init(struct Assembler_Processing *asp, const struct Config *config,
   }
   CLEANUP_IF_FAIL(asp->cdsg);
 
+  asp->program = prog_create();
+  CLEANUP_IF_FAIL(asp->program);
+
   return 1;
 
 cleanup:
@@ -243,6 +350,18 @@ void asp_deinit(struct Assembler_Processing *asp) {
   if (asp->cdsg) {
     cdsg_free(&asp->cdsg);
   }
+  if (asp->source) {
+    fu_source_free(&asp->source);
+  }
+  if (asp->fixups) {
+    jree_clear((void **)&asp->fixups);
+  }
+  asp->fixup_count = 0;
+  asp->fixup_capacity = 0;
+  if (asp->program) {
+    prog_free(&asp->program);
+  }
+  jarena_deinit(&asp->arena);
 }
 
 void asp_free(struct Assembler_Processing **asp) {
@@ -256,132 +375,89 @@ void asp_free(struct Assembler_Processing **asp) {
 
 // ===== STATIC HELPER DEFINITIONS =====
 
-static enum Err_Main _err_convert(enum Err_Asm err) { // TODO:
-  return err == ASM_NO_ERROR ? ERR_NO_ERROR : ERR_SYNTAX_ERROR;
-}
-
-static const struct Token **_convert_tokens(const struct Token *orig) {
-  size_t count = 0, i = 0;
-  const struct Token **res = NULL;
-  RETURN_IF_FAIL(orig, NULL);
-
-  while (orig[count].type != TOKEN_EOF) {
-    count++;
-  }
-  count++; // also count EOF
-
-  res = jalloc((count + 1) * sizeof(*res)); // +1 for NULL terminator
-  RETURN_IF_FAIL(res, NULL);
-
-  for (i = 0; i < count; i++) {
-    res[i] = &orig[i];
-  }
-  res[count] = NULL;
-
-  return res;
-}
-
-static void _free_tokens_convertor(const struct Token **tokens[]) {
-  if (!tokens || !*tokens) {
-    return;
-  }
-  jree((void *)*tokens);
-  *tokens = NULL;
-}
-
-static struct Parsed_Statement *_parse_tokens(const struct Token *tokens,
-                                              size_t nl) {
-  struct Parsed_Statement *pstmt = NULL;
-  const struct Token **converted_tokens = NULL;
-  RETURN_IF_FAIL(tokens, 0);
-  converted_tokens = _convert_tokens(tokens);
-  RETURN_IF_FAIL(converted_tokens, NULL);
-
-  pstmt = parse_tokens(converted_tokens, nl);
-
-  if (converted_tokens) {
-    // cast out const, because of free
-    _free_tokens_convertor(&converted_tokens);
-  }
-  return pstmt;
-}
-
-static enum Err_Asm _pass(struct Assembler_Processing *asp, int is_second) {
-  enum Assembler_Context ctx = ASC_FILE_START;
-  char *line = NULL;
-  size_t line_len = 0, nl = 1;
-  FILE *f = NULL;
-  enum Err_Asm err = ASM_NO_ERROR;
-  RETURN_IF_FAIL(asp != NULL, ASM_INVALID_ARGS);
-  PRINT_VERBOSE("STARTING PASS %i\n", is_second ? 2 : 1);
-  RET_VERBOSE_CLN_IF_FAIL(fu_open(asp->config->source, &f),
-                          ASM_CANNOT_OPEN_FILE, "Couldn't open file: %s\n",
-                          asp->config->source);
-
-  while (fu_getline(&line, &line_len, f) != -1) {
-    if (is_second) {
-      REUSE_ERR_IF_FAIL(_pass2_line(asp, &ctx, nl, line));
-    } else {
-      REUSE_ERR_IF_FAIL(_pass1_line(asp, &ctx, nl, line));
-    }
-    nl++;
-  }
-
-cleanup:
-  if (f) {
-    fclose(f);
-    f = NULL;
-  }
-  if (line) {
-    jree(line);
-    line = NULL;
+static enum Err_Main _err_convert(enum Err_Asm err) {
+  switch (err) {
+  case ASM_NO_ERROR:
+    return ERR_NO_ERROR;
+  case ASM_CANNOT_OPEN_FILE:
+    return ERR_INVALID_INPUT_FILE;
+  case ASM_UNRESOLVED_SYMBOL:
+    return ERR_UNRESOLVED_REFERENCE;
+  case ASM_CDSG_TOO_LARGE:
+    return ERR_CODE_SEGMENT_TOO_LARGE;
+  case ASM_DTSG_TOO_LARGE:
+    return ERR_DATA_SEGMENT_TOO_LARGE;
+  case ASM_SYMTAB_CANNOT_ADD:
+  case ASM_DTSG_CANNOT_APPEND:
+  case ASM_CDSG_CANNOT_APPEND:
+  case ASM_PROGRAM_CANNOT_APPEND:
+    return ERR_OUT_OF_MEMORY;
+  case ASM_KMA_EXPECTED:
+  case ASM_KMA_DOUBLE:
+  case ASM_INVALID_ARGS:
+  case ASM_CREATING_TOKENS:
+  case ASM_CREATING_PSTMT:
+  case ASM_DATA_ABROAD:
+  case ASM_CODE_ABROAD:
+  case ASM_UNKNOWN_PSTMT_TYPE:
+  case ASM_DTSG_CANNOT_ADVANCE:
+  case ASM_CDSG_CANNOT_ADVANCE:
+  case ASM_SYMTAB_ALREADY_EXIST:
+  case ASM_INVALID_INSTUCTION:
+  case ASM_UNKNOWN_INIT_SEG:
+  case ASM_INVALID_REGISTER:
+  default:
+    return ERR_SYNTAX_ERROR;
   }
-  return err;
 }
 
-static enum Err_Asm _pass_line(struct Assembler_Processing *asp,
-                               enum Assembler_Context *ctx, size_t nl,
-                               const char *line, int is_second) {
+static enum Err_Asm _pass1_line(struct Assembler_Processing *asp,
+                                enum Assembler_Context *ctx,
+                                const struct Fu_Line *line) {
   struct Token *tokens = NULL;
   struct Parsed_Statement *pstmt = NULL;
+  struct Jarena_Mark mark = {0};
+  uint64_t t = 0;
   enum Err_Asm err = ASM_NO_ERROR;
+  size_t nl = line->number;
+  jarena_mark(&asp->arena, &mark);
 
   PRINT_VERBOSE("Tokenizing line.\n");
-  tokens = lexer_tokenize_line(line, nl);
+  STATS_START();
+  tokens = lexer_tokenize_arena(&asp->arena, line->text, line->len, nl,
+                                asp->symtab);
+  STATS_LAP(STATS_LEX);
   ERR_IF_FAIL(tokens, ASM_CREATING_TOKENS);
-  if (asp->config->flag_verbose) {
+  if (VERBOSE_ON) {
     print_tokens(tokens);
   }
   PRINT_VERBOSE("Parsing tokens.\n");
-  pstmt = _parse_tokens(tokens, nl);
+  pstmt = parse_tokens_arena(&asp->arena, tokens, nl);
+  STATS_LAP(STATS_PARSE);
   ERR_IF_FAIL(pstmt &&
                   (pstmt->err == PAR_NO_ERROR || pstmt->err == PAR_EMPTY_LINE),
               ASM_CREATING_PSTMT);
 
   PRINT_VERBOSE("Evaluating parsed statement.\n");
-  if (is_second) {
-    REUSE_ERR_IF_FAIL(_pass2_decide(pstmt, asp, ctx, nl));
+  REUSE_ERR_IF_FAIL(_pass1_decide(pstmt, asp, ctx, nl));
+  if (!asp->config->flag_single_pass) { // single pass has nothing to remember
+    STATS_LAP(STATS_PASS1);
+    ERR_IF_FAIL(prog_app(asp->program, pstmt), ASM_PROGRAM_CANNOT_APPEND);
+    STATS_LAP(STATS_PROGRAM);
+  } else if (pstmt->type == STMT_INSTRUCTION) { // encoded while deciding
+    STATS_LAP(STATS_ENCODE);
   } else {
-    REUSE_ERR_IF_FAIL(_pass1_decide(pstmt, asp, ctx, nl));
+    STATS_LAP(STATS_PASS1);
+  }
+  if (STATS_ON) {
+    _pass1_count_line(asp, tokens, pstmt);
   }
 
 cleanup:
-  if (tokens) {
-    lexer_free_tokens(tokens);
-    tokens = NULL;
-  }
-  if (pstmt) {
-    p_stmt_free(&pstmt);
-  }
+  jarena_reset(&asp->arena, &mark); // tokens & pstmt, without any free
   return err;
 }
 
-static enum Err_Asm _pass1_line(struct Assembler_Processing *asp,
-                                enum Assembler_Context *ctx, size_t nl,
-                                const char *line) {
-  return _pass_line(asp, ctx, nl, line, 0);
-}
-
 static enum Err_Asm _pass1_decide(struct Parsed_Statement *pstmt,
                                   struct Assembler_Processing *asp,
                                   enum Assembler_Context *ctx, size_t nl) {
@@ -459,7 +535,9 @@ static enum Err_Asm _pass1_data_decl(struct Parsed_Statement *pstmt,
                                      struct Assembler_Processing *asp,
                                      enum Assembler_Context *ctx, size_t nl) {
   size_t position = SIZE_MAX, size = SIZE_MAX;
-  char *identifier = NULL;
+  struct Symbol *symbol = NULL;
+  int inserted = 0;
+  enum Err_Asm err = ASM_NO_ERROR;
   PRINT_VERBOSE("Found DATA DECLARATION on line %zu, ", nl);
   RET_VERBOSE_CLN_IF_FAIL(pstmt && asp && asp->config && ctx, ASM_INVALID_ARGS,
                           "but something went WRONG.\n");
@@ -468,14 +546,8 @@ static enum Err_Asm _pass1_data_decl(struct Parsed_Statement *pstmt,
       "but that IS NOT in the DATA section, resulting in ERROR.\n");
 
   size = pstmt->content.data_decl.total_size;
-  identifier = pstmt->content.data_decl.identifier;
+  position = dtsg_get_size(asp->dtsg);
 
-  PRINT_VERBOSE_CLN("ADVANCING DATASEGMENT of TOTALSIZE=%zu, ", size);
-  position = dtsg_advance(asp->dtsg, size);
-
-  RET_VERBOSE_CLN_IF_FAIL(position != SIZE_MAX, ASM_DTSG_CANNOT_ADVANCE,
-                          "but when trying to 'reserve' the space in data "
-                          "segment, ERROR happened.\n");
   RET_VERBOSE_CLN_IF_FAIL(
       size <= KMA_DTSG_BYTES, ASM_DTSG_TOO_LARGE,
       "but requested size %zu is larger than whole data segment (%zu).\n", size,
@@ -489,17 +561,147 @@ static enum Err_Asm _pass1_data_decl(struct Parsed_Statement *pstmt,
       "but data segment position %zu does not fit into 32-bit address.\n",
       position);
 
+  symbol = _pass1_define_symbol(asp, pstmt->content.data_decl.identifier_id,
+                                position, SYM_DATA, &inserted);
+  RET_VERBOSE_CLN_IF_FAIL(symbol, ASM_SYMTAB_CANNOT_ADD,
+                          "but identifier couldn't be added to the symbol "
+                          "table.\n");
   RET_VERBOSE_CLN_IF_FAIL(
-      symtab_find(asp->symtab, identifier) == NULL, ASM_SYMTAB_ALREADY_EXIST,
+      inserted, ASM_SYMTAB_ALREADY_EXIST,
       "but identifier %s was already used = illegal redeclaration.\n",
-      identifier);
+      symtab_name(asp->symtab, symbol));
 
-  RET_VERBOSE_CLN_IF_FAIL(
-      symtab_add(asp->symtab, identifier, (uint32_t)position),
-      ASM_SYMTAB_CANNOT_ADD,
-      "but identifier %s couldn't be added to the symbol table.\n", identifier);
+  // only uninitialized declarations at the very end of data are BSS
+  if (pstmt->content.data_decl.is_fully_uninit) {
+    asp->bss_size += size;
+  } else {
+    asp->bss_size = 0;
+  }
 
+  // data never reference symbols, so they are emitted right away
+  PRINT_VERBOSE_CLN("EMITTING %zu bytes on position %zu, ", size, position);
+  REUSE_ERR_IF_FAIL(_pass1_data_emit(&pstmt->content.data_decl, asp));
   PRINT_VERBOSE_CLN("everything is OK.\n");
+
+cleanup:
+  return err;
+}
+
+static enum Err_Asm _pass1_data_emit(const struct Data_Declaration *dd,
+                                     struct Assembler_Processing *asp) {
+  size_t i = 0;
+  const struct Init_Segment *is = NULL;
+  enum Err_Asm err = ASM_NO_ERROR;
+  RETURN_IF_FAIL(dd && dd->segments && asp && asp->dtsg, ASM_INVALID_ARGS);
+  // grown once for all segments, so values can be appended unchecked
+  RET_VERBOSE_CLN_IF_FAIL(
+      dtsg_ensure_fits(asp->dtsg, dd->literal_size), ASM_DTSG_CANNOT_APPEND,
+      "but its %zu bytes don't fit into data segment.\n", dd->literal_size);
+
+  for (i = 0; i < dd->segment_count; i++) {
+    is = &dd->segments[i];
+    switch (is->type) {
+    case INIT_SEG_UNINIT:
+      REUSE_ERR_IF_FAIL(_pass1_data_decl_uninit(asp, is, dd->type));
+      break;
+    case INIT_SEG_VALUE:
+      REUSE_ERR_IF_FAIL(_pass1_data_decl_value(asp, is, dd->type));
+      break;
+    case INIT_SEG_STRING:
+      REUSE_ERR_IF_FAIL(_pass1_data_decl_string(asp, is));
+      break;
+    case INIT_SEG_DUP:
+      REUSE_ERR_IF_FAIL(_pass1_data_decl_dup(asp, is, dd->type));
+      break;
+    default:
+      PRINT_VERBOSE_CLN("but the segment is of UNKNOWN type!\n");
+      return ASM_UNKNOWN_INIT_SEG;
+    }
+  }
+
+cleanup:
+  return err;
+}
+
+static enum Err_Asm _pass1_data_decl_uninit(struct Assembler_Processing *asp,
+                                            const struct Init_Segment *is,
+                                            enum Data_Type dt) {
+  size_t bytes = 0;
+  RETURN_IF_FAIL(asp && asp->dtsg && is, ASM_INVALID_ARGS);
+
+  // the same size as counted in total_size by parser
+  bytes = is->element_count * (dt == DATA_DWORD ? 4 : 1);
+  RET_VERBOSE_CLN_IF_FAIL(
+      dtsg_app_zs(asp->dtsg, bytes), ASM_DTSG_CANNOT_APPEND,
+      "but couldn't append %zu UNINITIALIZED bytes to data segment.\n",
+      bytes);
+
+  PRINT_VERBOSE_CLN("appended %zu UNINITIALIZED bytes to data segment, ",
+                    bytes);
+  return ASM_NO_ERROR;
+}
+
+static enum Err_Asm _pass1_data_decl_value(struct Assembler_Processing *asp,
+                                           const struct Init_Segment *is,
+                                           enum Data_Type dt) {
+  uint8_t byte = 0;
+  RETURN_IF_FAIL(asp && asp->dtsg && is, ASM_INVALID_ARGS);
+
+  // space was ensured for the whole declaration in _pass1_data_emit
+  if (dt == DATA_BYTE) {
+    byte = (uint8_t)(is->data.value & 0xFF);
+    dtsg_app_b_unchecked(asp->dtsg, byte);
+    PRINT_VERBOSE_CLN("appended byte 0x%02X to data segment, ", byte);
+  } else if (dt == DATA_DWORD) {
+    dtsg_app_dw_unchecked(asp->dtsg, is->data.value);
+    PRINT_VERBOSE_CLN("appended DOUBLE WORD %i to data segment, ",
+                      is->data.value);
+  }
+
+  return ASM_NO_ERROR;
+}
+
+static enum Err_Asm _pass1_data_decl_string(struct Assembler_Processing *asp,
+                                            const struct Init_Segment *is) {
+  RETURN_IF_FAIL(asp && asp->dtsg && is, ASM_INVALID_ARGS);
+
+  RET_VERBOSE_CLN_IF_FAIL(
+      dtsg_app_bs(asp->dtsg, (const uint8_t *)is->data.string.text,
+                  is->data.string.len),
+      ASM_DTSG_CANNOT_APPEND,
+      "but couldn't append string of %zu bytes to data segment.\n",
+      is->data.string.len);
+  PRINT_VERBOSE_CLN("appended string '%.*s' to data segment, ",
+                    (int)is->data.string.len, is->data.string.text);
+
+  return ASM_NO_ERROR;
+}
+
+static enum Err_Asm _pass1_data_decl_dup(struct Assembler_Processing *asp,
+                                         const struct Init_Segment *is,
+                                         enum Data_Type dt) {
+  uint8_t byte = 0;
+  RETURN_IF_FAIL(asp && asp->dtsg && is, ASM_INVALID_ARGS);
+
+  if (dt == DATA_BYTE) {
+    byte = (uint8_t)(is->data.dup.value & 0xFF);
+    RET_VERBOSE_CLN_IF_FAIL(
+        dtsg_app_b_n(asp->dtsg, byte, is->data.dup.count),
+        ASM_DTSG_CANNOT_APPEND,
+        "but couldn't append %zu times byte 0x%02X to data segment.\n",
+        is->data.dup.count, byte);
+    PRINT_VERBOSE_CLN("appended %zu times byte 0x%02X to data segment, ",
+                      is->data.dup.count, byte);
+  } else if (dt == DATA_DWORD) {
+    RET_VERBOSE_CLN_IF_FAIL(
+        dtsg_app_dw_n(asp->dtsg, is->data.dup.value, is->data.dup.count),
+        ASM_DTSG_CANNOT_APPEND,
+        "but couldn't append %zu times DWord %i to data segment.\n",
+        is->data.dup.count, is->data.dup.value);
+    PRINT_VERBOSE_CLN("appended %zu times DWord %i to data segment, ",
+                      is->data.dup.count, is->data.dup.value);
+  }
+
   return ASM_NO_ERROR;
 }
 
@@ -507,6 +709,7 @@ static enum Err_Asm _pass1_instruction(struct Parsed_Statement *pstmt,
                                        struct Assembler_Processing *asp,
                                        enum Assembler_Context *ctx, size_t nl) {
   size_t size = SIZE_MAX, position = SIZE_MAX;
+  uint8_t *out = NULL;
   PRINT_VERBOSE("Found INSTRUCTION on line %zu, ", nl);
   RET_VERBOSE_CLN_IF_FAIL(pstmt && asp && asp->config && ctx, ASM_INVALID_ARGS,
                           "but something went WRONG.\n");
@@ -521,8 +724,7 @@ static enum Err_Asm _pass1_instruction(struct Parsed_Statement *pstmt,
       "but either the instructions size is 0 or some other error occured.\n");
   PRINT_VERBOSE_CLN("retrieved the size of instruction (%zu), ", size);
 
-  PRINT_VERBOSE_CLN("ADVANCING CODESEGMENT of TOTALSIZE=%zu, ", size);
-  position = cdsg_advance(asp->cdsg, size);
+  position = cdsg_get_size(asp->cdsg);
   RET_VERBOSE_CLN_IF_FAIL(
       position <= KMA_CDSG_BYTES - size, ASM_CDSG_TOO_LARGE,
       "but code segment overflow: position=%zu size=%zu capacity=%zu.\n",
@@ -532,6 +734,19 @@ static enum Err_Asm _pass1_instruction(struct Parsed_Statement *pstmt,
       "but code segment position %zu does not fit into 32-bit address.\n",
       position);
 
+  if (asp->config->flag_single_pass) {
+    out = cdsg_reserve(asp->cdsg, size);
+    RET_VERBOSE_CLN_IF_FAIL(out, ASM_CDSG_CANNOT_APPEND,
+                            "but %zu bytes couldn't be appended.\n", size);
+    return _encode_instruction(asp, &pstmt->content.instruction, out,
+                               position, nl);
+  }
+
+  PRINT_VERBOSE_CLN("ADVANCING CODESEGMENT of TOTALSIZE=%zu, ", size);
+  RET_VERBOSE_CLN_IF_FAIL(cdsg_advance(asp->cdsg, size) == position,
+                          ASM_CDSG_CANNOT_ADVANCE,
+                          "but code segment couldn't be advanced.\n");
+
   PRINT_VERBOSE_CLN(
       "and reserved the place in code segment for it, on position %zu\n",
       position);
@@ -541,13 +756,15 @@ static enum Err_Asm _pass1_instruction(struct Parsed_Statement *pstmt,
 static enum Err_Asm _pass1_label_def(struct Parsed_Statement *pstmt,
                                      struct Assembler_Processing *asp,
                                      enum Assembler_Context *ctx, size_t nl) {
-  char *label_name = NULL;
+  struct Symbol *symbol = NULL;
   size_t position = SIZE_MAX;
+  int inserted = 0;
   PRINT_VERBOSE("Found LABEL definition on line %zu, ", nl);
   RET_VERBOSE_CLN_IF_FAIL(pstmt && asp && asp->config && ctx, ASM_INVALID_ARGS,
                           "but something went WRONG.\n");
-  label_name = pstmt->content.label_def.label_name;
-  PRINT_VERBOSE_CLN("the label name is (%s), ", label_name);
+  symbol = symtab_get(asp->symtab, pstmt->content.label_def.label_id);
+  PRINT_VERBOSE_CLN("the label name is (%s), ",
+                    symbol ? symtab_name(asp->symtab, symbol) : "?");
   RET_VERBOSE_CLN_IF_FAIL(
       *ctx == ASC_CODE, ASM_CODE_ABROAD,
       "but that IS NOT in the CODE section, resulting in ERROR.\n");
@@ -563,20 +780,89 @@ static enum Err_Asm _pass1_label_def(struct Parsed_Statement *pstmt,
       "but code segment position %zu does not fit into 32-bit address.\n",
       position);
 
+  symbol = _pass1_define_symbol(asp, pstmt->content.label_def.label_id,
+                                position, SYM_LABEL, &inserted);
+  RET_VERBOSE_CLN_IF_FAIL(symbol, ASM_SYMTAB_CANNOT_ADD,
+                          "but label couldn't be added to the symbol table.\n");
   RET_VERBOSE_CLN_IF_FAIL(
-      symtab_find(asp->symtab, label_name) == NULL, ASM_SYMTAB_ALREADY_EXIST,
+      inserted, ASM_SYMTAB_ALREADY_EXIST,
       "but label name %s was already used = illegal redeclaration.\n",
-      label_name);
-  RET_VERBOSE_CLN_IF_FAIL(
-      symtab_add(asp->symtab, label_name, (uint32_t)position),
-      ASM_SYMTAB_CANNOT_ADD,
-      "but identifier %s couldn't be added to the symbol table.\n", label_name);
+      symtab_name(asp->symtab, symbol));
 
   PRINT_VERBOSE_CLN("and saved its position (%zu) in the symbol table.\n",
                     position);
   return ASM_NO_ERROR;
 }
 
+static struct Symbol *_pass1_define_symbol(struct Assembler_Processing *asp,
+                                           uint32_t id, size_t address,
+                                           enum Symbol_Kind kind,
+                                           int *defined) {
+  struct Symbol *symbol = NULL;
+  RETURN_IF_FAIL(asp && asp->symtab && defined, NULL);
+
+  symbol = symtab_get(asp->symtab, id);
+  RETURN_IF_FAIL(symbol, NULL);
+
+  *defined = 0;
+  if (symbol->kind == SYM_UNKNOWN) {
+    symbol->kind = (uint8_t)kind;
+    symbol->address = (uint32_t)address;
+    *defined = 1;
+  }
+  return symbol;
+}
+
+static void _pass1_count_line(struct Assembler_Processing *asp,
+                              const struct Token *tokens,
+                              const struct Parsed_Statement *pstmt) {
+  const struct Token *tok = NULL;
+  asp->stats.lines++;
+  for (tok = tokens; tok->type != TOKEN_EOF; tok++) {
+    asp->stats.tokens++;
+  }
+  if (pstmt->type != STMT_NONE) {
+    asp->stats.statements++;
+  }
+}
+
+static size_t _pass1_count_defined(const struct Assembler_Processing *asp) {
+  size_t i = 0, count = 0;
+  for (i = 0; i < asp->symtab->count; i++) {
+    if (asp->symtab->symbols[i].kind != SYM_UNKNOWN) {
+      count++;
+    }
+  }
+  return count;
+}
+
+static enum Err_Asm _pass1_resolve_fixups(struct Assembler_Processing *asp) {
+  const struct Asm_Fixup *fixup = NULL;
+  const struct Symbol *symbol = NULL;
+  size_t i = 0;
+  enum Err_Asm err = ASM_NO_ERROR;
+  RETURN_IF_FAIL(asp && asp->config && asp->symtab && asp->cdsg,
+                 ASM_INVALID_ARGS);
+  PRINT_VERBOSE("RESOLVING %zu forward references\n", asp->fixup_count);
+
+  for (i = 0; i < asp->fixup_count; i++) {
+    fixup = &asp->fixups[i];
+    symbol = symtab_get(asp->symtab, (uint32_t)fixup->symbol_id);
+    RETURN_IF_FAIL(symbol, ASM_INVALID_ARGS);
+    if (symbol->kind != fixup->kind) { // report all, not only the first one
+      PRINT_VERBOSE("Reference on line %zu to %s %s is not defined.\n",
+                    fixup->line,
+                    fixup->kind == SYM_LABEL ? "label" : "identifier",
+                    symtab_name(asp->symtab, symbol));
+      err = ASM_UNRESOLVED_SYMBOL;
+      continue;
+    }
+    _store_le32(asp->cdsg->bytes + fixup->code_offset, symbol->address);
+  }
+
+  return err;
+}
+
 static enum Err_Asm _pass1_none(struct Assembler_Processing *asp, size_t nl) {
   PRINT_VERBOSE(
       "Found NOTHIMG on line %zu, might be an empty line, or only comment.\n",
@@ -589,155 +875,148 @@ static enum Err_Asm _pass1_error(struct Assembler_Processing *asp, size_t nl) {
   return ASM_UNKNOWN_PSTMT_TYPE;
 }
 
-static enum Err_Asm _pass2_line(struct Assembler_Processing *asp,
-                                enum Assembler_Context *ctx, size_t nl,
-                                const char *line) {
-  return _pass_line(asp, ctx, nl, line, 1);
-}
+static enum Err_Asm _pass2_instruction(const struct Program_Statement *stmt,
+                                       struct Assembler_Processing *asp) {
+  const struct Instruction_Statement *is = NULL;
+  uint8_t *out = NULL;
+  size_t size = 0, position = 0;
+  PRINT_VERBOSE("Found INSTRUCTION on line %zu, ",
+                stmt ? stmt->line_number : 0);
+  RET_VERBOSE_CLN_IF_FAIL(stmt && (is = &stmt->instruction) &&
+                              is->descriptor && asp && asp->config &&
+                              asp->cdsg,
+                          ASM_INVALID_ARGS, "but something went WRONG.\n");
 
-static enum Err_Asm _pass2_decide(struct Parsed_Statement *pstmt,
-                                  struct Assembler_Processing *asp,
-                                  enum Assembler_Context *ctx, size_t nl) {
-  RETURN_IF_FAIL(pstmt && asp && ctx, ASM_INVALID_ARGS);
+  // the whole instruction is one slice, written without further checks, the
+  // segment is already sized by the 1st pass
+  size = instruction_get_encoded_size(is->descriptor);
+  position = cdsg_get_size(asp->cdsg);
+  RET_VERBOSE_CLN_IF_FAIL(
+      size > 0 && cdsg_fits(asp->cdsg, size), ASM_CDSG_CANNOT_APPEND,
+      "but %zu bytes don't fit into code segment on position %zu.\n", size,
+      position);
+  out = cdsg_reserve_unchecked(asp->cdsg, size);
 
-  switch (pstmt->type) {
-  case STMT_KMA:
-    return _pass1_kma(asp, ctx, nl); // intentional
-  case STMT_SECTION_CODE:
-    return _pass1_code_section(asp, ctx, nl); // intentional
-  case STMT_SECTION_DATA:
-    return _pass1_data_section(asp, ctx, nl); // intentional
-  case STMT_DATA_DECL:
-    return _pass2_data_decl(pstmt, asp, ctx, nl);
-  case STMT_INSTRUCTION:
-    return _pass2_instruction(pstmt, asp, ctx, nl);
-  case STMT_LABEL_DEF:
-    return ASM_NO_ERROR; // label definition belongs to 1st pass
-  case STMT_NONE:
-    return _pass1_none(asp, nl); // intentional
-  case STMT_ERROR:
-  default:
-    return _pass1_error(asp, nl); // intentional
-  }
+  return _encode_instruction(asp, is, out, position, stmt->line_number);
 }
 
-static enum Err_Asm _pass2_data_decl(struct Parsed_Statement *pstmt,
-                                     struct Assembler_Processing *asp,
-                                     enum Assembler_Context *ctx, size_t nl) {
-  // checks
-  // for all segments save them into datasegment
-  size_t i = 0;
-  const struct Data_Declaration *dd = NULL;
-  const struct Init_Segment *is = NULL;
+static enum Err_Asm _encode_instruction(struct Assembler_Processing *asp,
+                                        const struct Instruction_Statement *is,
+                                        uint8_t *out, size_t position,
+                                        size_t line) {
+  const struct Operand *op = NULL;
+  enum Register_Code reg = REG_COUNT;
+  size_t i = 0, at = 1; // out[0] is opcode
+  uint32_t value = 0;
   enum Err_Asm err = ASM_NO_ERROR;
-  PRINT_VERBOSE("Found DATA DECLARATION on line %zu, ", nl);
-  RET_VERBOSE_CLN_IF_FAIL(pstmt && (dd = &pstmt->content.data_decl) &&
-                              dd->segments && asp && asp->config && ctx,
-                          ASM_INVALID_ARGS, "but something went WRONG.\n");
-
-  for (i = 0; i < dd->segment_count; i++) {
-    is = &dd->segments[i];
-    switch (is->type) {
-    case INIT_SEG_UNINIT:
-      REUSE_ERR_IF_FAIL(_pass2_data_decl_uninit(asp, is));
-      break;
-    case INIT_SEG_VALUE:
-      REUSE_ERR_IF_FAIL(_pass2_data_decl_value(asp, is, dd->type));
+  RETURN_IF_FAIL(asp && asp->config && is && is->descriptor && out,
+                 ASM_INVALID_ARGS);
+
+  out[0] = is->descriptor->opcode;
+  for (i = 0; i < 2; i++) {
+    op = &is->operands[i];
+    switch ((enum Operand_Type)op->type) {
+    case OP_REG:
+      reg = (enum Register_Code)op->value.reg;
+      RET_VERBOSE_CLN_IF_FAIL(reg < REG_COUNT, ASM_INVALID_REGISTER,
+                              "but register %i is unknown.\n", (int)reg);
+      out[at++] = (uint8_t)reg;
       break;
-    case INIT_SEG_STRING:
-      REUSE_ERR_IF_FAIL(_pass2_data_decl_string(asp, is));
-      break;
-    case INIT_SEG_DUP:
-      REUSE_ERR_IF_FAIL(_pass2_data_decl_dup(asp, is, dd->type));
+    case OP_IMM32:
+      REUSE_ERR_IF_FAIL(
+          _operand_value(asp, op, position + at, line, &value));
+      _store_le32(&out[at], value);
+      at += 4;
       break;
+    case OP_NONE:
+    case OP_TYPE_COUNT:
     default:
-      PRINT_VERBOSE_CLN("but the segment is of UNKNOWN type!\n");
-      return ASM_UNKNOWN_INIT_SEG;
+      break;
     }
   }
 
+  PRINT_VERBOSE_CLN("encoded it into %zu bytes on position %zu.\n", at,
+                    position);
+  print_instruction(asp->config->flag_instruction, line, is, position);
+
 cleanup:
   return err;
 }
 
-static enum Err_Asm _pass2_instruction(struct Parsed_Statement *pstmt,
-                                       struct Assembler_Processing *asp,
-                                       enum Assembler_Context *ctx, size_t nl) {
-  return ASM_NO_ERROR;
-}
-
-static enum Err_Asm _pass2_data_decl_uninit(struct Assembler_Processing *asp,
-                                            const struct Init_Segment *is) {
-  RETURN_IF_FAIL(asp && asp->dtsg && is, ASM_INVALID_ARGS);
-
-  RET_VERBOSE_CLN_IF_FAIL(
-      dtsg_app_zs(asp->dtsg, is->element_count), ASM_DTSG_CANNOT_APPEND,
-      "but couldn't append %zu UNINITIALIZED bytes to data segment.\n",
-      is->element_count);
-
-  PRINT_VERBOSE_CLN("appended %zu UNINITIALIZED bytes to data segment, ");
-  return ASM_NO_ERROR;
-}
-
-static enum Err_Asm _pass2_data_decl_value(struct Assembler_Processing *asp,
-                                           const struct Init_Segment *is,
-                                           enum Data_Type dt) {
-  uint8_t byte = 0;
-  RETURN_IF_FAIL(asp && asp->dtsg && is, ASM_INVALID_ARGS);
-
-  if (dt == DATA_BYTE) {
-    byte = (uint8_t)(is->data.value & 0xFF);
-    RET_VERBOSE_CLN_IF_FAIL(
-        dtsg_app_b(asp->dtsg, byte), ASM_DTSG_CANNOT_APPEND,
-        "but couldn't append byte 0x%02X to data segment.\n", byte);
-    PRINT_VERBOSE_CLN("appended byte 0x%02X to data segment, ", byte);
-  } else if (dt == DATA_DWORD) {
+static enum Err_Asm _operand_value(struct Assembler_Processing *asp,
+                                   const struct Operand *op,
+                                   size_t code_offset, size_t line,
+                                   uint32_t *value) {
+  const struct Symbol *symbol = NULL;
+  enum Symbol_Kind kind = SYM_UNKNOWN;
+  RETURN_IF_FAIL(asp && asp->config && asp->symtab && op && value,
+                 ASM_INVALID_ARGS);
+
+  switch ((enum Operand_Specifier)op->specifier) {
+  case OPS_LABEL:
+  case OPS_OFFSET:
+    kind = op->specifier == OPS_LABEL ? SYM_LABEL : SYM_DATA;
+    symbol = symtab_get(asp->symtab, op->value.symbol_id);
+    RET_VERBOSE_CLN_IF_FAIL(symbol, ASM_INVALID_ARGS,
+                            "but its symbol id %u is unknown.\n",
+                            (unsigned)op->value.symbol_id);
+    if (asp->config->flag_single_pass && symbol->kind == SYM_UNKNOWN) {
+      // forward reference, the placeholder is defined later in place
+      RET_VERBOSE_CLN_IF_FAIL(
+          _app_fixup(asp, code_offset, op->value.symbol_id, line, kind),
+          ASM_SYMTAB_CANNOT_ADD, "but reference to %s couldn't be saved.\n",
+          symtab_name(asp->symtab, symbol));
+      *value = 0;
+      return ASM_NO_ERROR;
+    }
     RET_VERBOSE_CLN_IF_FAIL(
-        dtsg_app_dw(asp->dtsg, is->data.value), ASM_DTSG_CANNOT_APPEND,
-        "but couldn't append  to data segment.\n", is->data.value);
-    PRINT_VERBOSE_CLN("appended DOUBLE WORD %i to data segment, ",
-                      is->data.value);
+        symbol->kind == kind, ASM_UNRESOLVED_SYMBOL,
+        "but %s %s is not defined.\n",
+        kind == SYM_LABEL ? "label" : "identifier",
+        symtab_name(asp->symtab, symbol));
+    *value = symbol->address;
+    return ASM_NO_ERROR;
+  case OPS_NONE:
+  default:
+    *value = (uint32_t)op->value.immediate_value;
+    return ASM_NO_ERROR;
   }
-
-  return ASM_NO_ERROR;
 }
 
-static enum Err_Asm _pass2_data_decl_string(struct Assembler_Processing *asp,
-                                            const struct Init_Segment *is) {
-  RETURN_IF_FAIL(asp && asp->dtsg && is, ASM_INVALID_ARGS);
-
-  RET_VERBOSE_CLN_IF_FAIL(
-      dtsg_app_str(asp->dtsg, is->data.string), ASM_DTSG_CANNOT_APPEND,
-      "but couldn't append string '%s' to data segment.\n", is->data.string);
-  PRINT_VERBOSE_CLN("appended string '%s' to data segment, ", is->data.string);
+static int _app_fixup(struct Assembler_Processing *asp, size_t code_offset,
+                      size_t symbol_id, size_t line, enum Symbol_Kind kind) {
+  struct Asm_Fixup *new_f = NULL, *fixup = NULL;
+  size_t new_c = 0;
+  RETURN_IF_FAIL(asp, 0);
+
+  if (!asp->fixups) {
+    asp->fixups =
+        jalloc(ASM_FIXUPS_INITIAL_CAPACITY * sizeof(struct Asm_Fixup));
+    RETURN_IF_FAIL(asp->fixups, 0);
+    asp->fixup_capacity = ASM_FIXUPS_INITIAL_CAPACITY;
+    asp->fixup_count = 0;
+  } else if (asp->fixup_count == asp->fixup_capacity) {
+    RETURN_IF_FAIL(asp->fixup_capacity <= SIZE_MAX / ASM_FIXUPS_CAPACITY_MULT /
+                                              sizeof(struct Asm_Fixup),
+                   0); // multiply overflow
+    new_c = asp->fixup_capacity * ASM_FIXUPS_CAPACITY_MULT;
+    new_f = jealloc(asp->fixups, new_c * sizeof(struct Asm_Fixup));
+    RETURN_IF_FAIL(new_f, 0);
+    asp->fixups = new_f;
+    asp->fixup_capacity = new_c;
+  }
 
-  return ASM_NO_ERROR;
+  fixup = &asp->fixups[asp->fixup_count++];
+  fixup->code_offset = code_offset;
+  fixup->symbol_id = symbol_id;
+  fixup->line = line;
+  fixup->kind = (uint8_t)kind;
+  return 1;
 }
 
-static enum Err_Asm _pass2_data_decl_dup(struct Assembler_Processing *asp,
-                                         const struct Init_Segment *is,
-                                         enum Data_Type dt) {
-  uint8_t byte = 0;
-  RETURN_IF_FAIL(asp && asp->dtsg && is, ASM_INVALID_ARGS);
-
-  if (dt == DATA_BYTE) {
-    byte = (uint8_t)(is->data.dup.value & 0xFF);
-    RET_VERBOSE_CLN_IF_FAIL(
-        dtsg_app_b_n(asp->dtsg, byte, is->data.dup.count),
-        ASM_DTSG_CANNOT_APPEND,
-        "but couldn't append %zu times byte 0x%02X to data segment.\n",
-        is->data.dup.count, byte);
-    PRINT_VERBOSE_CLN("appended %zu timesbyte 0x%02X to data segment, ",
-                      is->data.dup.count, byte);
-  } else if (dt == DATA_DWORD) {
-    RET_VERBOSE_CLN_IF_FAIL(
-        dtsg_app_dw_n(asp->dtsg, is->data.dup.value, is->data.dup.count),
-        ASM_DTSG_CANNOT_APPEND,
-        "but couldn't append %zu times DWord %i to data segment.\n",
-        is->data.dup.count, is->data.dup.value);
-    PRINT_VERBOSE_CLN("appended %zu times DWord %i to data segment, ",
-                      is->data.dup.count, is->data.dup.value);
-  }
-
-  return ASM_NO_ERROR;
+static void _store_le32(uint8_t *dst, uint32_t value) {
+  dst[0] = (uint8_t)(value & 0xFF);
+  dst[1] = (uint8_t)((value >> 8) & 0xFF);
+  dst[2] = (uint8_t)((value >> 16) & 0xFF);
+  dst[3] = (uint8_t)((value >> 24) & 0xFF);
 }
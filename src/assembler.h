@@ -4,16 +4,39 @@
 #include "codeseg.h"
 #include "common.h"
 #include "dataseg.h"
+#include "fileutil.h"
+#include "memory.h"
+#include "program.h"
+#include "stats.h"
 #include "symbol.h"
 
 #define KMA_CDSG_BYTES (256 * 1024)
 #define KMA_DTSG_BYTES (256 * 1024)
+#define ASM_FIXUPS_INITIAL_CAPACITY 16
+#define ASM_FIXUPS_CAPACITY_MULT 2
+
+// Reference to a symbol which wasn't defined yet, when its instruction was
+// encoded in single-pass mode. The imm32 is patched after the whole source.
+struct Asm_Fixup {
+  size_t code_offset; // of the imm32 in code segment
+  size_t symbol_id;   // position in symtab->symbols
+  size_t line;        // of the instruction, for reporting
+  uint8_t kind;       // enum Symbol_Kind the symbol must be defined as
+};
 
 struct Assembler_Processing {
   const struct Config *config;
   struct Symbol_Table *symtab;
   struct Data_Segment *dtsg;
   struct Code_Segment *cdsg;
+  struct Fu_Source *source; // loaded once on first pass, shared by both
+  struct Program *program;  // statements from 1st pass, emitted in 2nd pass
+  size_t bss_size; // trailing uninitialized data, only its size is in output
+  struct Asm_Fixup *fixups; // single-pass only, allocated on first use
+  size_t fixup_count;
+  size_t fixup_capacity;
+  struct Jarena arena; // tokens & statements of one line, reset after it
+  struct Stats stats;  // filled only with config->flag_stats
 };
 
 enum Assembler_Context {
@@ -43,26 +66,34 @@ enum Err_Asm {
   ASM_CDSG_TOO_LARGE,
   ASM_UNKNOWN_INIT_SEG,
   ASM_DTSG_CANNOT_APPEND,
+  ASM_PROGRAM_CANNOT_APPEND,
+  ASM_CDSG_CANNOT_APPEND,
+  ASM_UNRESOLVED_SYMBOL,
+  ASM_INVALID_REGISTER,
 };
 
-// Wrapper around 2-pass assembler to binary process.
+// Wrapper around 2-pass assembler to binary process. With
+// config->flag_single_pass the 1st pass encodes instructions right away and
+// only patches the forward references at the end, the 2nd pass is skipped.
 // Return exact error code.
 enum Err_Main process_assembler(struct Assembler_Processing *asp);
 
 // First pass of assembler code = evaluates the whole file, creates a symbol
-// table and fills it with actual values in code/data segment. Return error
-// codes based on assignment error codes table
+// table and fills it with actual values in code/data segment. Every statement
+// the 2nd pass needs is remembered in asp->program. Return error codes based
+// on assignment error codes table
 enum Err_Asm pass1(struct Assembler_Processing *asp);
 
-// Second pass of assembler code = evaluates the whole file, using a symbol
-// table it writes into code segment with actual values. Return adequate error
-// code.
+// Second pass of assembler code = walks the program built by the 1st pass,
+// using a symbol table it writes into code segment with actual values. Return
+// adequate error code.
 // WARN: Doesn't check for syntax/etc. that's the role of 1st pass.
 enum Err_Asm pass2(struct Assembler_Processing *asp);
 
 // Create new ASsembler Processing struct. Call asp_init to initialize from
 // given parameters. If any is missing (NULL), the init will allocate new.
-// Only exception is config, which can only be given.
+// Only exception is config, which can only be given. The program is always
+// allocated new.
 struct Assembler_Processing *asp_create(const struct Config *config,
                                         struct Symbol_Table *symtab,
                                         struct Data_Segment *dtsg,
@@ -1,3 +1,4 @@
+#include <assert.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <string.h>
@@ -108,6 +109,28 @@ cleanup:
   return 0;
 }
 
+uint8_t *cdsg_reserve(struct Code_Segment *cdsg, size_t num_bytes) {
+  uint8_t *slice = NULL;
+  CLEANUP_IF_FAIL(cdsg && cdsg->bytes && num_bytes > 0);
+
+  CLEANUP_IF_FAIL(_cdsg_ensure_capacity(cdsg, num_bytes));
+
+  slice = cdsg->bytes + cdsg->size;
+  cdsg->size += num_bytes;
+  return slice;
+
+cleanup:
+  return NULL;
+}
+
+uint8_t *cdsg_reserve_unchecked(struct Code_Segment *cdsg, size_t num_bytes) {
+  uint8_t *slice = cdsg->bytes + cdsg->size;
+  assert(cdsg_fits(cdsg, num_bytes));
+
+  cdsg->size += num_bytes;
+  return slice;
+}
+
 size_t cdsg_get_size(const struct Code_Segment *cdsg) {
   CLEANUP_IF_FAIL(cdsg);
 
@@ -143,14 +166,30 @@ cleanup:
 }
 
 int cdsg_begin(struct Code_Segment *cdsg) {
-  if (!cdsg) {
+  uint8_t *new_b = NULL;
+  if (!cdsg || !cdsg->bytes) {
     return 0;
   }
 
+  // 0 bytes can't be reallocated, keep the initial buffer then
+  if (cdsg->size > 0 && cdsg->size != cdsg->capacity) {
+    new_b = jealloc(cdsg->bytes, cdsg->size);
+    RETURN_IF_FAIL(new_b, 0);
+    cdsg->bytes = new_b;
+    cdsg->capacity = cdsg->size;
+  }
+
   cdsg->size = 0;
   return 1;
 }
 
+int cdsg_fits(const struct Code_Segment *cdsg, size_t num_bytes) {
+  RETURN_IF_FAIL(cdsg, 0);
+  RETURN_IF_FAIL(cdsg->size <= cdsg->capacity, 0); // only advanced, not begun
+
+  return num_bytes <= cdsg->capacity - cdsg->size;
+}
+
 static int _cdsg_ensure_capacity(struct Code_Segment *cdsg,
                                  size_t additional_b) {
   size_t req = 0, new_c = 0;
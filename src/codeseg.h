@@ -40,6 +40,16 @@ int cdsg_app_reg(struct Code_Segment *cdsg, uint8_t reg_code);
 // Return 1 on success, 0 on failure.
 int cdsg_app_imm(struct Code_Segment *cdsg, int32_t imm32b_v);
 
+// Code Segment Reserve: grow the segment by num_bytes at once and return
+// pointer to the first of them, so a whole instruction is written directly
+// with one capacity check. Pointer is valid only until next append/reserve.
+// Return NULL on failure.
+uint8_t *cdsg_reserve(struct Code_Segment *cdsg, size_t num_bytes);
+
+// Code Segment Reserve, the same as cdsg_reserve, but without any checks.
+// Fast path for 2nd pass: cdsg_fits must be already checked for num_bytes.
+uint8_t *cdsg_reserve_unchecked(struct Code_Segment *cdsg, size_t num_bytes);
+
 // Code Segment get size.
 size_t cdsg_get_size(const struct Code_Segment *cdsg);
 
@@ -52,7 +62,13 @@ const uint8_t *cdsg_get_bytes(const struct Code_Segment *cdsg);
 size_t cdsg_advance(struct Code_Segment *cdsg, size_t num_bytes);
 
 // Code Segment: Go to the beginning of the segment.
-// Useful for reseting after 1st pass.
+// Useful for reseting after 1st pass. The size reached in 1st pass is the
+// final size, so the buffer is reallocated to exactly that capacity once, and
+// the 2nd pass never grows it.
 // WARN: Only use after 1st pass!
 int cdsg_begin(struct Code_Segment *cdsg);
+
+// Code Segment: Check if num_bytes can be appended without growing the buffer.
+// Return 1 if they fit, 0 otherwise.
+int cdsg_fits(const struct Code_Segment *cdsg, size_t num_bytes);
 #endif
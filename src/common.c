@@ -6,18 +6,37 @@
 #include "common.h"
 #include "instruction.h"
 
+static enum Log_Level log_level = LOG_VERBOSE;
+static char log_buffer[LOG_BUFFER_SIZE];
+
+// Write message of level, prefixed by prefix (may be NULL), into the log.
+static void _log_vmessage(enum Log_Level level, const char *prefix,
+                          const char *string, va_list args);
+
+void log_init(void) {
+  setvbuf(stdout, log_buffer, _IOFBF, sizeof(log_buffer));
+}
+
+void log_set_level(enum Log_Level level) { log_level = level; }
+
+void log_message(enum Log_Level level, const char *string, ...) {
+  va_list args;
+  va_start(args, string);
+  _log_vmessage(level, NULL, string, args);
+  va_end(args);
+}
+
+void log_flush(void) { fflush(stdout); }
+
 void print_verbose(int condition, const char *string, ...) {
   if (!condition) {
     return;
   }
 
-  printf("[VERBOSE] ");
   va_list args;
   va_start(args, string);
-  vprintf(string, args);
+  _log_vmessage(LOG_VERBOSE, "[VERBOSE] ", string, args);
   va_end(args);
-
-  fflush(stdout); // TODO: remove after debug
 }
 
 void print_verbose_clean(int condition, const char *string, ...) {
@@ -27,20 +46,35 @@ void print_verbose_clean(int condition, const char *string, ...) {
 
   va_list args;
   va_start(args, string);
-  vprintf(string, args);
+  _log_vmessage(LOG_VERBOSE, NULL, string, args);
   va_end(args);
-
-  fflush(stdout); // TODO: remove after debug
 }
 
 void print_instruction(int condition, size_t line,
-                       struct Instruction_Statement *is, size_t addr) {
+                       const struct Instruction_Statement *is, size_t addr) {
   if (!condition || !is || !is->descriptor || !is->descriptor->mnemonic) {
     return;
   }
 
   // TODO: nicely output the operands...
-  printf("[INSTR] L%zu: %s %s %s at CS:%zu\n", line, is->descriptor->mnemonic,
-         (is->operands[0].type != OP_NONE) ? "OP1" : "",
-         (is->operands[1].type != OP_NONE) ? "OP2" : "", addr);
+  log_message(LOG_INFO, "[INSTR] L%zu: %s %s %s at CS:%zu\n", line,
+              is->descriptor->mnemonic,
+              (is->operands[0].type != OP_NONE) ? "OP1" : "",
+              (is->operands[1].type != OP_NONE) ? "OP2" : "", addr);
+}
+
+static void _log_vmessage(enum Log_Level level, const char *prefix,
+                          const char *string, va_list args) {
+  if (level > log_level || !string) {
+    return;
+  }
+
+  if (prefix) {
+    fputs(prefix, stdout);
+  }
+  vfprintf(stdout, string, args);
+
+  if (level == LOG_ERROR) { // nothing logged before an error may be lost
+    log_flush();
+  }
 }
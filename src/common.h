@@ -22,6 +22,24 @@
 
 #define DEBUG 1
 
+// Build with KMAS_NO_VERBOSE defined (make RELEASE=1) to compile all verbose
+// output out, -v is still accepted but prints nothing.
+#ifdef KMAS_NO_VERBOSE
+#define VERBOSE_BUILD 0
+#else
+#define VERBOSE_BUILD 1
+#endif
+
+// Size of the log buffer, see log_init.
+#define LOG_BUFFER_SIZE (64 * 1024)
+
+// Importance of a log message, the sink drops messages above its level.
+enum Log_Level {
+  LOG_ERROR = 0, // always written & flushed right away
+  LOG_INFO,      // normal output, e.g. instructions of -i
+  LOG_VERBOSE,   // output of -v
+};
+
 // Errors specific to main, which the program outputs.
 enum Err_Main {
   ERR_NO_ERROR = 0,
@@ -39,10 +57,26 @@ enum Err_Main {
 struct Config {
   int flag_verbose;
   int flag_instruction;
+  int flag_single_pass; // encode in 1st pass, patch forward refs by fixups
+  int flag_stats;       // enum Stats_Format, by --stats or --stats=json
   char *source;
   char *target;
 };
 
+// Make the log sink (stdout) fully buffered by LOG_BUFFER_SIZE bytes, so it is
+// written only when full, on LOG_ERROR message or by log_flush. Must be called
+// before anything is printed.
+void log_init(void);
+
+// Drop all messages above level from now on. Default is LOG_VERBOSE.
+void log_set_level(enum Log_Level level);
+
+// Write message of given level into the log, printf-like.
+void log_message(enum Log_Level level, const char *string, ...);
+
+// Write out everything buffered in the log.
+void log_flush(void);
+
 // United verbose output to console.
 // Only print if condition is met, variadic arguments will be forwarded to
 // printf function from stdio.h, which require the first argument to be
@@ -62,6 +96,6 @@ void print_verbose_clean(int condition, const char *string, ...);
 // e.g.:
 // L50: DEC A at CS:123
 void print_instruction(int condition, size_t line,
-                       struct Instruction_Statement *is, size_t addr);
+                       const struct Instruction_Statement *is, size_t addr);
 
 #endif
@@ -1,3 +1,4 @@
+#include <assert.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <string.h>
@@ -12,6 +13,21 @@
 static int _dtsg_ensure_capacity(struct Data_Segment *dtsg,
                                  size_t additional_b);
 
+// Fill total bytes of dst by repeating the pattern, doubling the copied prefix.
+static void _dtsg_fill(uint8_t *dst, const uint8_t *pattern, size_t pattern_len,
+                       size_t total);
+
+// Grow the extents list if needed, so one more extent fits.
+// Return 0 on failure, 1 on success.
+static int _dtsg_ensure_extents(struct Data_Segment *dtsg);
+
+// Append run of length bytes repeating the pattern (1 or 4 bytes). Literal
+// bytes appended since the last extent are closed into LITERAL extent first,
+// run directly following the same run is merged into it.
+// Return 0 on failure, 1 on success.
+static int _dtsg_app_run(struct Data_Segment *dtsg, const uint8_t *pattern,
+                         size_t pattern_len, size_t length);
+
 struct Data_Segment *dtsg_create(void) {
   struct Data_Segment *dtsg = NULL;
   dtsg = jalloc(sizeof(struct Data_Segment));
@@ -19,6 +35,11 @@ struct Data_Segment *dtsg_create(void) {
 
   dtsg->size = 0;
   dtsg->capacity = DTSG_INITIAL_CAPACITY;
+  dtsg->extents = NULL; // flat by default
+  dtsg->extent_count = 0;
+  dtsg->extent_capacity = 0;
+  dtsg->literal_mark = 0;
+  dtsg->runs_size = 0;
 
   dtsg->bytes = jalloc(dtsg->capacity);
   CLEANUP_IF_FAIL(dtsg->bytes);
@@ -39,11 +60,139 @@ void dtsg_free(struct Data_Segment **dtsg) {
   if ((*dtsg)->bytes) {
     jree((*dtsg)->bytes);
   }
+  if ((*dtsg)->extents) {
+    jree((*dtsg)->extents);
+  }
   jree(*dtsg);
   *dtsg = NULL;
   return;
 }
 
+int dtsg_use_extents(struct Data_Segment *dtsg) {
+  CLEANUP_IF_FAIL(dtsg && dtsg->size == 0);
+
+  if (dtsg->extents) {
+    return 1; // already used
+  }
+
+  dtsg->extents =
+      jalloc(DTSG_EXTENTS_INITIAL_CAPACITY * sizeof(struct Dtsg_Extent));
+  CLEANUP_IF_FAIL(dtsg->extents);
+  dtsg->extent_capacity = DTSG_EXTENTS_INITIAL_CAPACITY;
+  dtsg->extent_count = 0;
+  dtsg->literal_mark = 0;
+  dtsg->runs_size = 0;
+  return 1;
+
+cleanup:
+  return 0;
+}
+
+int dtsg_flatten(struct Data_Segment *dtsg) {
+  struct Dtsg_Extent ext;
+  uint8_t *flat = NULL;
+  size_t total = 0, pos = 0, i = 0, count = 0;
+  CLEANUP_IF_FAIL(dtsg && dtsg->bytes);
+
+  if (!dtsg->extents) {
+    return 1; // already flat
+  }
+
+  total = dtsg->size + dtsg->runs_size;
+  if (dtsg->runs_size > 0) {
+    flat = jalloc(total);
+    CLEANUP_IF_FAIL(flat);
+
+    count = dtsg_get_extent_count(dtsg);
+    for (i = 0; i < count; i++) {
+      CLEANUP_IF_FAIL(dtsg_get_extent(dtsg, i, &ext));
+      if (ext.kind == DTSG_EXT_LITERAL) {
+        memcpy(flat + pos, dtsg->bytes + ext.start, ext.length);
+      } else {
+        dtsg_extent_fill(&ext, flat + pos, ext.length);
+      }
+      pos += ext.length;
+    }
+
+    jree(dtsg->bytes);
+    dtsg->bytes = flat;
+    dtsg->size = total;
+    dtsg->capacity = total;
+  }
+
+  jree(dtsg->extents);
+  dtsg->extents = NULL;
+  dtsg->extent_count = 0;
+  dtsg->extent_capacity = 0;
+  dtsg->literal_mark = 0;
+  dtsg->runs_size = 0;
+  return 1;
+
+cleanup:
+  if (flat) {
+    jree(flat);
+  }
+  return 0;
+}
+
+size_t dtsg_get_extent_count(const struct Data_Segment *dtsg) {
+  CLEANUP_IF_FAIL(dtsg);
+
+  if (!dtsg->extents) {
+    return dtsg->size > 0 ? 1 : 0;
+  }
+  return dtsg->extent_count + (dtsg->size > dtsg->literal_mark ? 1 : 0);
+
+cleanup:
+  return 0;
+}
+
+int dtsg_get_extent(const struct Data_Segment *dtsg, size_t i,
+                    struct Dtsg_Extent *extent) {
+  size_t listed = 0;
+  CLEANUP_IF_FAIL(dtsg && extent && i < dtsg_get_extent_count(dtsg));
+
+  listed = dtsg->extents ? dtsg->extent_count : 0;
+  if (i < listed) {
+    *extent = dtsg->extents[i];
+    return 1;
+  }
+
+  // the trailing literal bytes, not closed by any run yet
+  memset(extent, 0, sizeof(*extent));
+  extent->kind = DTSG_EXT_LITERAL;
+  extent->start = dtsg->literal_mark;
+  extent->length = dtsg->size - dtsg->literal_mark;
+  return 1;
+
+cleanup:
+  return 0;
+}
+
+int dtsg_extent_fill(const struct Dtsg_Extent *extent, uint8_t *dst,
+                     size_t len) {
+  CLEANUP_IF_FAIL(extent && dst);
+
+  switch ((enum Dtsg_Extent_Kind)extent->kind) {
+  case DTSG_EXT_ZERO:
+    memset(dst, 0, len);
+    break;
+  case DTSG_EXT_BYTE:
+    memset(dst, extent->pattern[0], len);
+    break;
+  case DTSG_EXT_DWORD:
+    _dtsg_fill(dst, extent->pattern, 4, len);
+    break;
+  case DTSG_EXT_LITERAL:
+  default:
+    return 0;
+  }
+  return 1;
+
+cleanup:
+  return 0;
+}
+
 int dtsg_app_b(struct Data_Segment *dtsg, uint8_t b) {
   CLEANUP_IF_FAIL(dtsg && dtsg->bytes);
 
@@ -59,21 +208,39 @@ cleanup:
 }
 
 int dtsg_app_dw_n(struct Data_Segment *dtsg, int32_t dw, size_t n) {
+  uint8_t bytes[4];
   CLEANUP_IF_FAIL(dtsg && dtsg->bytes);
 
+  bytes[0] = (uint8_t)((dw >> 0) & 0xFF);
+  bytes[1] = (uint8_t)((dw >> 8) & 0xFF);
+  bytes[2] = (uint8_t)((dw >> 16) & 0xFF);
+  bytes[3] = (uint8_t)((dw >> 24) & 0xFF);
+
+  return dtsg_app_pattern(dtsg, bytes, 4, n); // DWORD = 4 bytes
+
+cleanup:
+  return 0;
+}
+
+int dtsg_app_pattern(struct Data_Segment *dtsg, const uint8_t *pattern,
+                     size_t pattern_len, size_t n) {
+  size_t total = 0;
+  CLEANUP_IF_FAIL(dtsg && dtsg->bytes && pattern && pattern_len > 0);
+
   if (n == 0) {
     return 1; // nothing to do
   }
 
-  // DWORD = 4 bytes
-  CLEANUP_IF_FAIL(_dtsg_ensure_capacity(dtsg, n * 4));
+  CLEANUP_IF_FAIL(n <= SIZE_MAX / pattern_len); // multiply overflow
+  total = n * pattern_len;
 
-  for (size_t i = 0; i < n; i++) {
-    if (!dtsg_app_dw(dtsg, dw)) {
-      return 0;
-    }
+  if (dtsg->extents && (pattern_len == 1 || pattern_len == 4)) {
+    return _dtsg_app_run(dtsg, pattern, pattern_len, total);
   }
 
+  CLEANUP_IF_FAIL(_dtsg_ensure_capacity(dtsg, total));
+  _dtsg_fill(dtsg->bytes + dtsg->size, pattern, pattern_len, total);
+  dtsg->size += total;
   return 1;
 
 cleanup:
@@ -98,17 +265,9 @@ cleanup:
 }
 
 int dtsg_app_b_n(struct Data_Segment *dtsg, uint8_t b, size_t n) {
-  CLEANUP_IF_FAIL(dtsg && dtsg->bytes && b);
-
-  if (n == 0) {
-    return 1; // nothing to do
-  }
+  CLEANUP_IF_FAIL(dtsg && dtsg->bytes);
 
-  CLEANUP_IF_FAIL(_dtsg_ensure_capacity(dtsg, n));
-
-  memset(dtsg->bytes + dtsg->size, b, n);
-  dtsg->size += n;
-  return 1;
+  return dtsg_app_pattern(dtsg, &b, 1, n);
 
 cleanup:
   return 0;
@@ -165,32 +324,42 @@ cleanup:
 }
 
 int dtsg_app_zs(struct Data_Segment *dtsg, size_t count) {
-  size_t i = 0;
   CLEANUP_IF_FAIL(dtsg && dtsg->bytes);
 
-  for (i = 0; i < count; i++) {
-    if (!dtsg_app_b(dtsg, 0)) {
-      return 0;
-    }
-  }
-
-  return 1;
+  return dtsg_app_b_n(dtsg, 0, count);
 
 cleanup:
   return 0;
 }
 
+void dtsg_app_b_unchecked(struct Data_Segment *dtsg, uint8_t b) {
+  assert(dtsg->capacity - dtsg->size >= 1);
+
+  dtsg->bytes[dtsg->size++] = b;
+}
+
+void dtsg_app_dw_unchecked(struct Data_Segment *dtsg, int32_t dw) {
+  uint8_t *dst = dtsg->bytes + dtsg->size;
+  assert(dtsg->capacity - dtsg->size >= 4);
+
+  dst[0] = (uint8_t)((dw >> 0) & 0xFF);
+  dst[1] = (uint8_t)((dw >> 8) & 0xFF);
+  dst[2] = (uint8_t)((dw >> 16) & 0xFF);
+  dst[3] = (uint8_t)((dw >> 24) & 0xFF);
+  dtsg->size += 4;
+}
+
 size_t dtsg_get_size(const struct Data_Segment *dtsg) {
   CLEANUP_IF_FAIL(dtsg);
 
-  return dtsg->size;
+  return dtsg->size + dtsg->runs_size;
 
 cleanup:
   return 0;
 }
 
 const uint8_t *dtsg_get_bytes(const struct Data_Segment *dtsg) {
-  CLEANUP_IF_FAIL(dtsg && dtsg->bytes);
+  CLEANUP_IF_FAIL(dtsg && dtsg->bytes && dtsg->runs_size == 0);
 
   return dtsg->bytes;
 
@@ -198,29 +367,8 @@ cleanup:
   return NULL;
 }
 
-size_t dtsg_advance(struct Data_Segment *dtsg, size_t num_bytes) {
-  size_t pos = 0;
-  CLEANUP_IF_FAIL(dtsg);
-
-  if (dtsg->size > SIZE_MAX - num_bytes) {
-    goto cleanup;
-  }
-
-  pos = dtsg->size;
-  dtsg->size += num_bytes;
-  return pos;
-
-cleanup:
-  return SIZE_MAX;
-}
-
-int dtsg_begin(struct Data_Segment *dtsg) {
-  if (!dtsg) {
-    return 0;
-  }
-
-  dtsg->size = 0;
-  return 1;
+int dtsg_ensure_fits(struct Data_Segment *dtsg, size_t num_bytes) {
+  return _dtsg_ensure_capacity(dtsg, num_bytes);
 }
 
 static int _dtsg_ensure_capacity(struct Data_Segment *dtsg,
@@ -257,3 +405,100 @@ static int _dtsg_ensure_capacity(struct Data_Segment *dtsg,
 cleanup:
   return 0;
 }
+
+static void _dtsg_fill(uint8_t *dst, const uint8_t *pattern, size_t pattern_len,
+                       size_t total) {
+  size_t done = 0, chunk = 0;
+
+  if (pattern_len == 1) {
+    memset(dst, pattern[0], total);
+    return;
+  }
+
+  done = pattern_len <= total ? pattern_len : total;
+  memcpy(dst, pattern, done);
+  while (done < total) { // copy of the prefix doubles it
+    chunk = done <= total - done ? done : total - done;
+    memcpy(dst + done, dst, chunk);
+    done += chunk;
+  }
+}
+
+static int _dtsg_ensure_extents(struct Data_Segment *dtsg) {
+  size_t new_c = 0;
+  struct Dtsg_Extent *new_e = NULL;
+  CLEANUP_IF_FAIL(dtsg && dtsg->extents);
+
+  if (dtsg->extent_count < dtsg->extent_capacity) {
+    return 1; // Already have enough space.
+  }
+
+  CLEANUP_IF_FAIL(dtsg->extent_capacity <=
+                  SIZE_MAX / DTSG_CAPACITY_MULT /
+                      sizeof(struct Dtsg_Extent)); // multiply overflow
+  new_c = dtsg->extent_capacity * DTSG_CAPACITY_MULT;
+
+  new_e = jealloc(dtsg->extents, new_c * sizeof(struct Dtsg_Extent));
+  CLEANUP_IF_FAIL(new_e); // realloc failed
+
+  dtsg->extents = new_e;
+  dtsg->extent_capacity = new_c;
+  return 1;
+
+cleanup:
+  return 0;
+}
+
+static int _dtsg_app_run(struct Data_Segment *dtsg, const uint8_t *pattern,
+                         size_t pattern_len, size_t length) {
+  struct Dtsg_Extent run, *ext = NULL;
+  size_t i = 0;
+  int zero = 1, same = 1;
+  CLEANUP_IF_FAIL(dtsg && dtsg->extents && pattern);
+  CLEANUP_IF_FAIL(dtsg->size + dtsg->runs_size <= SIZE_MAX - length);
+
+  if (length == 0) {
+    return 1; // nothing to do
+  }
+
+  memset(&run, 0, sizeof(run));
+  for (i = 0; i < pattern_len; i++) {
+    zero = zero && pattern[i] == 0;
+    same = same && pattern[i] == pattern[0];
+  }
+  if (zero) {
+    run.kind = DTSG_EXT_ZERO;
+  } else if (same) {
+    run.kind = DTSG_EXT_BYTE;
+    memset(run.pattern, pattern[0], sizeof(run.pattern));
+  } else {
+    run.kind = DTSG_EXT_DWORD;
+    memcpy(run.pattern, pattern, sizeof(run.pattern));
+  }
+  run.length = length;
+
+  if (dtsg->size > dtsg->literal_mark) {
+    CLEANUP_IF_FAIL(_dtsg_ensure_extents(dtsg));
+    ext = &dtsg->extents[dtsg->extent_count++];
+    memset(ext, 0, sizeof(*ext));
+    ext->kind = DTSG_EXT_LITERAL;
+    ext->start = dtsg->literal_mark;
+    ext->length = dtsg->size - dtsg->literal_mark;
+    dtsg->literal_mark = dtsg->size;
+  }
+
+  ext = dtsg->extent_count ? &dtsg->extents[dtsg->extent_count - 1] : NULL;
+  if (ext && ext->kind == run.kind &&
+      memcmp(ext->pattern, run.pattern, sizeof(run.pattern)) == 0) {
+    ext->length += length; // DWord runs are whole DWords, so it stays aligned
+  } else {
+    CLEANUP_IF_FAIL(_dtsg_ensure_extents(dtsg));
+    dtsg->extents[dtsg->extent_count++] = run;
+  }
+
+  dtsg->runs_size += length;
+  return 1;
+
+cleanup:
+  return 0;
+}
@@ -6,11 +6,38 @@
 
 #define DTSG_INITIAL_CAPACITY 16
 #define DTSG_CAPACITY_MULT 2
+#define DTSG_EXTENTS_INITIAL_CAPACITY 8
+
+// What an extent of data segment holds.
+enum Dtsg_Extent_Kind {
+  DTSG_EXT_LITERAL, // bytes stored in the buffer
+  DTSG_EXT_BYTE,    // one byte repeated
+  DTSG_EXT_DWORD,   // one little endian DWord repeated
+  DTSG_EXT_ZERO,    // zeroes
+};
+
+// Continuous part of data segment. Runs store only their pattern, so they
+// cost the same memory regardless of their length.
+struct Dtsg_Extent {
+  uint8_t kind;       // enum Dtsg_Extent_Kind
+  uint8_t pattern[4]; // repeated byte or DWord, unused for LITERAL and ZERO
+  size_t start;       // LITERAL: offset into bytes, runs: unused
+  size_t length;      // in bytes
+};
 
+// Data segment is flat by default: bytes holds the whole segment. With
+// extents enabled (see dtsg_use_extents) bytes holds only the literal data and
+// the runs appended by the _n functions are kept in the extents list.
 struct Data_Segment {
   uint8_t *bytes;  // byte buffer
   size_t size;     // currently used
   size_t capacity; // are allocated
+
+  struct Dtsg_Extent *extents; // NULL if the segment is flat
+  size_t extent_count;
+  size_t extent_capacity;
+  size_t literal_mark; // bytes already covered by LITERAL extents
+  size_t runs_size;    // bytes described only by run extents
 };
 
 // Create new Data Segment.
@@ -20,6 +47,30 @@ struct Data_Segment *dtsg_create(void);
 // Free Data segment.
 void dtsg_free(struct Data_Segment **dtsg);
 
+// Keep repeated bytes, DWords and zeroes of following appends as extents
+// instead of writing them into the buffer. Only possible on empty segment.
+// Return 1 on success, 0 on failure.
+int dtsg_use_extents(struct Data_Segment *dtsg);
+
+// Write the extents into one flat buffer and switch the segment back to flat.
+// Does nothing on flat segment.
+// Return 1 on success, 0 on failure.
+int dtsg_flatten(struct Data_Segment *dtsg);
+
+// Get number of extents, including the trailing literal bytes. Flat segment
+// has at most one LITERAL extent.
+size_t dtsg_get_extent_count(const struct Data_Segment *dtsg);
+
+// Get i-th extent into *extent.
+// Return 1 on success, 0 on failure.
+int dtsg_get_extent(const struct Data_Segment *dtsg, size_t i,
+                    struct Dtsg_Extent *extent);
+
+// Fill len bytes of dst by the repeated pattern of run extent, as if the run
+// started at dst. Return 1 on success, 0 on failure (e.g. LITERAL extent).
+int dtsg_extent_fill(const struct Dtsg_Extent *extent, uint8_t *dst,
+                     size_t len);
+
 // Data Segment Append Byte.
 // Return 1 on success, 0 on failure.
 int dtsg_app_b(struct Data_Segment *dtsg, uint8_t b);
@@ -29,10 +80,18 @@ int dtsg_app_b(struct Data_Segment *dtsg, uint8_t b);
 // Return 1 on success, 0 on failure.
 int dtsg_app_bs(struct Data_Segment *dtsg, const uint8_t *bs, size_t count);
 
-// Data Segment Append one byte N-times.
+// Data Segment Append one byte N-times. With extents it's appended as a run.
 // Return 1 on success, 0 on failure.
 int dtsg_app_b_n(struct Data_Segment *dtsg, uint8_t b, size_t n);
 
+// Data Segment Append Pattern of pattern_len bytes N-times. The pattern is
+// written once and then the already written prefix is copied with doubling
+// length, so it costs about log2(n) memcpy calls. With extents the patterns of
+// 1 or 4 bytes are appended as a run.
+// Return 1 on success, 0 on failure.
+int dtsg_app_pattern(struct Data_Segment *dtsg, const uint8_t *pattern,
+                     size_t pattern_len, size_t n);
+
 // Data Segment Append DWord - little endian.
 // Return 1 on success, 0 on failure.
 int dtsg_app_dw(struct Data_Segment *dtsg, int32_t dw);
@@ -42,7 +101,7 @@ int dtsg_app_dw(struct Data_Segment *dtsg, int32_t dw);
 // Return 1 on success, 0 on failure.
 int dtsg_app_dws(struct Data_Segment *dtsg, const int32_t *dws, size_t count);
 
-// Data Segment Append one DWord N-times.
+// Data Segment Append one DWord N-times. With extents it's appended as a run.
 // Return 1 on success, 0 on failure.
 int dtsg_app_dw_n(struct Data_Segment *dtsg, int32_t dw, size_t n);
 
@@ -52,24 +111,28 @@ int dtsg_app_dw_n(struct Data_Segment *dtsg, int32_t dw, size_t n);
 // Return 1 on success, 0 on failure.
 int dtsg_app_str(struct Data_Segment *dtsg, const char *string);
 
-// Data Segment Append Zeroes.
+// Data Segment Append Zeroes. With extents it's appended as a run.
 // Return 1 on success, 0 on failure.
 int dtsg_app_zs(struct Data_Segment *dtsg, size_t count);
 
-// Data Segment get size.
+// Data Segment Append Byte, without any checks.
+// Fast path: dtsg_ensure_fits must be already called.
+void dtsg_app_b_unchecked(struct Data_Segment *dtsg, uint8_t b);
+
+// Data Segment Append DWord - little endian, without any checks.
+// Fast path: dtsg_ensure_fits must be already called.
+void dtsg_app_dw_unchecked(struct Data_Segment *dtsg, int32_t dw);
+
+// Data Segment get size, including the runs.
 size_t dtsg_get_size(const struct Data_Segment *dtsg);
 
 // Get pointer to Data Segment bytes. Read-only.
+// Return NULL if the segment has runs, dtsg_flatten it first.
 const uint8_t *dtsg_get_bytes(const struct Data_Segment *dtsg);
 
-// Data Segment: Advance number of bytes (for 1st pass).
-// Returns the offset where started, or SIZE_MAX on failure.
-// WARN: Only use in 1st pass!
-size_t dtsg_advance(struct Data_Segment *dtsg, size_t num_bytes);
-
-// Data Segment: Go to the beginning of the segment.
-// Useful for reseting after 1st pass.
-// WARN: Only use after 1st pass!
-int dtsg_begin(struct Data_Segment *dtsg);
+// Data Segment: Grow the buffer at once, so num_bytes can be appended without
+// any other growth (e.g. by the _unchecked functions). Size doesn't change.
+// Return 1 on success, 0 on failure.
+int dtsg_ensure_fits(struct Data_Segment *dtsg, size_t num_bytes);
 
 #endif
@@ -9,12 +9,27 @@
 #define R_OK 4         // read permission WIN
 #define W_OK 2         // write permission WIN
 #else
-#include <unistd.h> // for access UNIX
+#include <fcntl.h>    // for open UNIX
+#include <sys/mman.h> // for mmap UNIX
+#include <unistd.h>   // for access UNIX
 #endif
 
 #include "fileutil.h"
 #include "memory.h"
 
+// ===== PRIVATE FUNCTION DECLARATIONS =====
+
+// Read the whole stream into newly allocated buffer and save it into src.
+// Works for any stream, even if its size is not known beforehand.
+// Return 1 on success, 0 on failure.
+static int _fu_source_read(struct Fu_Source *src, FILE *f);
+
+// Try to mmap the file on path into src. Not available on WIN.
+// Return 1 on success, 0 on failure (caller may fallback to reading).
+static int _fu_source_map(struct Fu_Source *src, const char *path);
+
+// ===== PUBLIC FUNCTIONS =====
+
 int fu_path_exists(const char *path) {
   struct stat st = {0};
   if (!path) {
@@ -203,3 +218,156 @@ long fu_getline(char **lineptr, size_t *n, FILE *stream) {
   (*lineptr)[pos] = '\0';
   return (long)pos;
 }
+
+struct Fu_Source *fu_source_create(const char *path) {
+  struct Fu_Source *src = NULL;
+  FILE *f = NULL;
+  if (!path) {
+    return NULL;
+  }
+
+  src = jalloc(sizeof(struct Fu_Source));
+  if (!src) {
+    return NULL;
+  }
+
+  if (_fu_source_map(src, path)) {
+    return src;
+  }
+
+  // mapping not possible (WIN, pipe, ...), read everything at once
+  f = fopen(path, "rb");
+  if (!f || !_fu_source_read(src, f)) {
+    if (f) {
+      fclose(f);
+    }
+    jree(src);
+    return NULL;
+  }
+
+  fclose(f);
+  return src;
+}
+
+void fu_source_free(struct Fu_Source **src) {
+  if (!src || !*src) {
+    return;
+  }
+
+  if ((*src)->data) {
+#if !defined(_WIN32)
+    if ((*src)->is_mapped) {
+      munmap((*src)->data, (*src)->size);
+    } else {
+      jree((*src)->data);
+    }
+#else
+    jree((*src)->data);
+#endif
+  }
+
+  jree(*src);
+  *src = NULL;
+}
+
+int fu_source_next_line(const struct Fu_Source *src, struct Fu_Line *line) {
+  const char *start = NULL, *nl_ptr = NULL;
+  size_t left = 0;
+  if (!src || !line || line->next >= src->size || !src->data) {
+    return 0;
+  }
+
+  start = src->data + line->next;
+  left = src->size - line->next;
+  nl_ptr = memchr(start, '\n', left);
+
+  line->text = start;
+  line->len = nl_ptr ? (size_t)(nl_ptr - start) : left;
+  line->next += line->len + (nl_ptr ? 1 : 0); // skip the '\n' too
+  line->number++;
+
+  return 1;
+}
+
+// ===== PRIVATE FUNCTIONS =====
+
+static int _fu_source_read(struct Fu_Source *src, FILE *f) {
+  char *buf = NULL, *tmp = NULL;
+  size_t cap = FU_SOURCE_INIT_LEN, size = 0, got = 0;
+  if (!src || !f) {
+    return 0;
+  }
+
+  buf = jalloc(cap);
+  if (!buf) {
+    return 0;
+  }
+
+  while ((got = fread(buf + size, 1, cap - size, f)) > 0) {
+    size += got;
+    if (size < cap) {
+      continue; // short read, feof/ferror decide on next iteration
+    }
+    tmp = jealloc(buf, cap * 2);
+    if (!tmp) {
+      jree(buf);
+      return 0;
+    }
+    buf = tmp;
+    cap *= 2;
+  }
+
+  if (ferror(f)) {
+    jree(buf);
+    return 0;
+  }
+
+  src->data = buf;
+  src->size = size;
+  src->is_mapped = 0;
+  return 1;
+}
+
+static int _fu_source_map(struct Fu_Source *src, const char *path) {
+#if defined(_WIN32)
+  (void)src;
+  (void)path;
+  return 0;
+#else
+  struct stat st = {0};
+  void *map = NULL;
+  int fd = -1;
+  if (!src || !path) {
+    return 0;
+  }
+
+  fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return 0;
+  }
+
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size < 0) {
+    close(fd);
+    return 0;
+  }
+
+  if (st.st_size == 0) { // nothing to map, empty source is valid
+    close(fd);
+    src->data = NULL;
+    src->size = 0;
+    src->is_mapped = 0;
+    return 1;
+  }
+
+  map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // mapping stays valid after closing
+  if (map == MAP_FAILED) {
+    return 0;
+  }
+
+  src->data = map;
+  src->size = (size_t)st.st_size;
+  src->is_mapped = 1;
+  return 1;
+#endif
+}
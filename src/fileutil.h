@@ -1,9 +1,26 @@
 #ifndef FILE_UTIL_H
 #define FILE_UTIL_H
 
+#include <stddef.h>
 #include <stdio.h>
 
 #define FU_GETLINE_INIT_LEN 128
+#define FU_SOURCE_INIT_LEN 4096
+
+// Whole source file, read (or mapped) only once and shared by both passes.
+struct Fu_Source {
+  char *data;    // file contents, NOT NULL-terminated, NULL if empty
+  size_t size;   // number of bytes in data
+  int is_mapped; // 1 if data is mmap-ed, 0 if allocated via jalloc
+};
+
+// Zero-copy view of one line inside Fu_Source.
+struct Fu_Line {
+  const char *text; // start of the line, NOT NULL-terminated
+  size_t len;       // length of the line without the '\n'
+  size_t number;    // 1-based line number
+  size_t next;      // offset of the next line in source data
+};
 
 // Return 1 if path exists, 0 otherwise.
 int fu_path_exists(const char *path);
@@ -44,4 +61,17 @@ int fu_open(const char *path, FILE **f);
 // If *lineptr is NULL or *n is 0, allocate a buffer(caller must free).
 long fu_getline(char **lineptr, size_t *n, FILE *stream);
 
+// Map (or read at once, where mapping is not possible) the whole file from
+// path. Return pointer to the source on success, NULL on failure.
+// Must be freed by fu_source_free.
+struct Fu_Source *fu_source_create(const char *path);
+
+// Unmap/free the source data & the source itself. Set the pointer to NULL.
+void fu_source_free(struct Fu_Source **src);
+
+// Set line to view the next line in source. Line must be zero-initialized
+// before the first call, then only passed back unchanged.
+// Return 1 if line was set, 0 on end of source/failure.
+int fu_source_next_line(const struct Fu_Source *src, struct Fu_Line *line);
+
 #endif
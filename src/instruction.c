@@ -3,136 +3,215 @@
 
 #include "instruction.h"
 
-// The complete instruction set of KM processor.
-static const struct Instruction_Descriptor INSTRUCTION_TABLE[] = {
+// Encoded size of one operand, sizes are defined in assignment.
+#define OPERAND_SIZE(op) ((op) == OP_REG ? 1 : (op) == OP_IMM32 ? 4 : 0)
+
+// Place descriptor on its index in INSTRUCTION_TABLE, with precomputed size
+// (opcode byte and both operands).
+#define INSTR(name, opcode, op1, op2, count)                                   \
+  [MNEM_##name][op1][op2] = {                                                  \
+      #name, (opcode), (op1), (op2), (count), MNEM_##name,                     \
+      1 + OPERAND_SIZE(op1) + OPERAND_SIZE(op2)}
+
+// The complete instruction set of KM processor, indexed by mnemonic ID and
+// types of both operands. Entries of invalid combinations have NULL mnemonic.
+static const struct Instruction_Descriptor
+    INSTRUCTION_TABLE[MNEM_COUNT][OP_TYPE_COUNT][OP_TYPE_COUNT] = {
     // Control
-    {"HALT", 0x00, OP_NONE, OP_NONE, 0},
-    {"NOP", 0x90, OP_NONE, OP_NONE, 0},
+    INSTR(HALT, 0x00, OP_NONE, OP_NONE, 0),
+    INSTR(NOP, 0x90, OP_NONE, OP_NONE, 0),
 
     // Data movement
-    {"MOV", 0x10, OP_REG, OP_IMM32, 2},
-    {"MOV", 0x11, OP_REG, OP_REG, 2},
-    {"MOVSD", 0x12, OP_REG, OP_REG, 2},
-    {"LOAD", 0x13, OP_REG, OP_IMM32, 2},
-    {"LOAD", 0x14, OP_REG, OP_REG, 2},
-    {"STOR", 0x15, OP_REG, OP_IMM32, 2},
-    {"STOR", 0x16, OP_REG, OP_REG, 2},
+    INSTR(MOV, 0x10, OP_REG, OP_IMM32, 2),
+    INSTR(MOV, 0x11, OP_REG, OP_REG, 2),
+    INSTR(MOVSD, 0x12, OP_REG, OP_REG, 2),
+    INSTR(LOAD, 0x13, OP_REG, OP_IMM32, 2),
+    INSTR(LOAD, 0x14, OP_REG, OP_REG, 2),
+    INSTR(STOR, 0x15, OP_REG, OP_IMM32, 2),
+    INSTR(STOR, 0x16, OP_REG, OP_REG, 2),
 
     // Stack
-    {"PUSH", 0x20, OP_REG, OP_NONE, 1},
-    {"POP", 0x21, OP_REG, OP_NONE, 1},
+    INSTR(PUSH, 0x20, OP_REG, OP_NONE, 1),
+    INSTR(POP, 0x21, OP_REG, OP_NONE, 1),
 
     // Arithmetic
-    {"ADD", 0x30, OP_REG, OP_IMM32, 2},
-    {"ADD", 0x31, OP_REG, OP_REG, 2},
-    {"SUB", 0x32, OP_REG, OP_IMM32, 2},
-    {"SUB", 0x33, OP_REG, OP_REG, 2},
-    {"MUL", 0x34, OP_REG, OP_IMM32, 2},
-    {"MUL", 0x35, OP_REG, OP_REG, 2},
-    {"DIV", 0x36, OP_REG, OP_IMM32, 2},
-    {"DIV", 0x37, OP_REG, OP_REG, 2},
-    {"INC", 0x38, OP_REG, OP_NONE, 1},
-    {"DEC", 0x39, OP_REG, OP_NONE, 1},
+    INSTR(ADD, 0x30, OP_REG, OP_IMM32, 2),
+    INSTR(ADD, 0x31, OP_REG, OP_REG, 2),
+    INSTR(SUB, 0x32, OP_REG, OP_IMM32, 2),
+    INSTR(SUB, 0x33, OP_REG, OP_REG, 2),
+    INSTR(MUL, 0x34, OP_REG, OP_IMM32, 2),
+    INSTR(MUL, 0x35, OP_REG, OP_REG, 2),
+    INSTR(DIV, 0x36, OP_REG, OP_IMM32, 2),
+    INSTR(DIV, 0x37, OP_REG, OP_REG, 2),
+    INSTR(INC, 0x38, OP_REG, OP_NONE, 1),
+    INSTR(DEC, 0x39, OP_REG, OP_NONE, 1),
 
     // Logical
-    {"AND", 0x40, OP_REG, OP_IMM32, 2},
-    {"AND", 0x41, OP_REG, OP_REG, 2},
-    {"OR", 0x42, OP_REG, OP_IMM32, 2},
-    {"OR", 0x43, OP_REG, OP_REG, 2},
-    {"XOR", 0x44, OP_REG, OP_IMM32, 2},
-    {"XOR", 0x45, OP_REG, OP_REG, 2},
-    {"NOT", 0x46, OP_REG, OP_NONE, 1},
+    INSTR(AND, 0x40, OP_REG, OP_IMM32, 2),
+    INSTR(AND, 0x41, OP_REG, OP_REG, 2),
+    INSTR(OR, 0x42, OP_REG, OP_IMM32, 2),
+    INSTR(OR, 0x43, OP_REG, OP_REG, 2),
+    INSTR(XOR, 0x44, OP_REG, OP_IMM32, 2),
+    INSTR(XOR, 0x45, OP_REG, OP_REG, 2),
+    INSTR(NOT, 0x46, OP_REG, OP_NONE, 1),
 
     // Bit shifts
-    {"SHL", 0x50, OP_REG, OP_IMM32, 2},
-    {"SHL", 0x51, OP_REG, OP_REG, 2},
-    {"SHR", 0x52, OP_REG, OP_IMM32, 2},
-    {"SHR", 0x53, OP_REG, OP_REG, 2},
+    INSTR(SHL, 0x50, OP_REG, OP_IMM32, 2),
+    INSTR(SHL, 0x51, OP_REG, OP_REG, 2),
+    INSTR(SHR, 0x52, OP_REG, OP_IMM32, 2),
+    INSTR(SHR, 0x53, OP_REG, OP_REG, 2),
 
     // Compare
-    {"CMP", 0x60, OP_REG, OP_IMM32, 2},
-    {"CMP", 0x61, OP_REG, OP_REG, 2},
+    INSTR(CMP, 0x60, OP_REG, OP_IMM32, 2),
+    INSTR(CMP, 0x61, OP_REG, OP_REG, 2),
 
     // Jumps
-    {"JMP", 0x70, OP_IMM32, OP_NONE, 1},
-    {"JMP", 0x71, OP_REG, OP_NONE, 1},
-    {"JE", 0x72, OP_IMM32, OP_NONE, 1},
-    {"JNE", 0x73, OP_IMM32, OP_NONE, 1},
-    {"JG", 0x74, OP_IMM32, OP_NONE, 1},
-    {"JGE", 0x75, OP_IMM32, OP_NONE, 1},
-    {"JNG", 0x76, OP_IMM32, OP_NONE, 1},
-    {"JL", 0x77, OP_IMM32, OP_NONE, 1},
-    {"JLE", 0x78, OP_IMM32, OP_NONE, 1},
-    {"JNL", 0x79, OP_IMM32, OP_NONE, 1},
+    INSTR(JMP, 0x70, OP_IMM32, OP_NONE, 1),
+    INSTR(JMP, 0x71, OP_REG, OP_NONE, 1),
+    INSTR(JE, 0x72, OP_IMM32, OP_NONE, 1),
+    INSTR(JNE, 0x73, OP_IMM32, OP_NONE, 1),
+    INSTR(JG, 0x74, OP_IMM32, OP_NONE, 1),
+    INSTR(JGE, 0x75, OP_IMM32, OP_NONE, 1),
+    INSTR(JNG, 0x76, OP_IMM32, OP_NONE, 1),
+    INSTR(JL, 0x77, OP_IMM32, OP_NONE, 1),
+    INSTR(JLE, 0x78, OP_IMM32, OP_NONE, 1),
+    INSTR(JNL, 0x79, OP_IMM32, OP_NONE, 1),
 
     // Subroutine
-    {"CALL", 0x80, OP_IMM32, OP_NONE, 1},
-    {"CALL", 0x81, OP_REG, OP_NONE, 1},
-    {"RET", 0x82, OP_NONE, OP_NONE, 0},
+    INSTR(CALL, 0x80, OP_IMM32, OP_NONE, 1),
+    INSTR(CALL, 0x81, OP_REG, OP_NONE, 1),
+    INSTR(RET, 0x82, OP_NONE, OP_NONE, 0),
 
     // I/O
-    {"OUTD", 0xF0, OP_REG, OP_NONE, 1},
-    {"OUTC", 0xF1, OP_REG, OP_NONE, 1},
-    {"OUTS", 0xF2, OP_REG, OP_NONE, 1},
-    {"INPD", 0xF3, OP_REG, OP_NONE, 1},
-    {"INPC", 0xF4, OP_REG, OP_NONE, 1},
-    {"INPS", 0xF5, OP_REG, OP_NONE, 1},
+    INSTR(OUTD, 0xF0, OP_REG, OP_NONE, 1),
+    INSTR(OUTC, 0xF1, OP_REG, OP_NONE, 1),
+    INSTR(OUTS, 0xF2, OP_REG, OP_NONE, 1),
+    INSTR(INPD, 0xF3, OP_REG, OP_NONE, 1),
+    INSTR(INPC, 0xF4, OP_REG, OP_NONE, 1),
+    INSTR(INPS, 0xF5, OP_REG, OP_NONE, 1),
 };
 
-static const size_t INSTRUCTION_COUNT =
-    sizeof(INSTRUCTION_TABLE) / sizeof(INSTRUCTION_TABLE[0]);
-
-int instruction_is_mnemonic(const char *word, const size_t len) {
-  size_t i = 0, i_len = 0, w_len = 0;
-  if (!word) {
-    return 0;
+// If first len characters of word are mnemonic (string), return its ID.
+#define MNEMONIC(string, mnem_id)                                              \
+  if (len == sizeof(string) - 1 && memcmp(word, (string), len) == 0) {         \
+    return (mnem_id);                                                          \
   }
 
-  w_len = len;
-  if (len == 0) {
-    w_len = strlen(word);
+enum Mnemonic instruction_mnemonic_id(const char *word, const size_t len) {
+  if (!word || len < 2 || len > 5) { // shortest is JE, longest MOVSD
+    return MNEM_NONE;
   }
 
-  for (i = 0; i < INSTRUCTION_COUNT; i++) {
-    i_len = strlen(INSTRUCTION_TABLE[i].mnemonic);
-    if (w_len != i_len) {
-      continue; // skip different-length instructions
-    }
-    if (strncmp(INSTRUCTION_TABLE[i].mnemonic, word, w_len) == 0) {
-      return 1; // found match
+  // the first character leaves at most a few candidates to compare
+  switch (word[0]) {
+  case 'A':
+    MNEMONIC("ADD", MNEM_ADD);
+    MNEMONIC("AND", MNEM_AND);
+    break;
+  case 'C':
+    MNEMONIC("CMP", MNEM_CMP);
+    MNEMONIC("CALL", MNEM_CALL);
+    break;
+  case 'D':
+    MNEMONIC("DIV", MNEM_DIV);
+    MNEMONIC("DEC", MNEM_DEC);
+    break;
+  case 'H':
+    MNEMONIC("HALT", MNEM_HALT);
+    break;
+  case 'I':
+    MNEMONIC("INC", MNEM_INC);
+    MNEMONIC("INPD", MNEM_INPD);
+    MNEMONIC("INPC", MNEM_INPC);
+    MNEMONIC("INPS", MNEM_INPS);
+    break;
+  case 'J':
+    if (len == 2) {
+      MNEMONIC("JE", MNEM_JE);
+      MNEMONIC("JG", MNEM_JG);
+      MNEMONIC("JL", MNEM_JL);
+    } else {
+      MNEMONIC("JMP", MNEM_JMP);
+      MNEMONIC("JNE", MNEM_JNE);
+      MNEMONIC("JGE", MNEM_JGE);
+      MNEMONIC("JNG", MNEM_JNG);
+      MNEMONIC("JLE", MNEM_JLE);
+      MNEMONIC("JNL", MNEM_JNL);
     }
+    break;
+  case 'L':
+    MNEMONIC("LOAD", MNEM_LOAD);
+    break;
+  case 'M':
+    MNEMONIC("MOV", MNEM_MOV);
+    MNEMONIC("MUL", MNEM_MUL);
+    MNEMONIC("MOVSD", MNEM_MOVSD);
+    break;
+  case 'N':
+    MNEMONIC("NOP", MNEM_NOP);
+    MNEMONIC("NOT", MNEM_NOT);
+    break;
+  case 'O':
+    MNEMONIC("OR", MNEM_OR);
+    MNEMONIC("OUTD", MNEM_OUTD);
+    MNEMONIC("OUTC", MNEM_OUTC);
+    MNEMONIC("OUTS", MNEM_OUTS);
+    break;
+  case 'P':
+    MNEMONIC("POP", MNEM_POP);
+    MNEMONIC("PUSH", MNEM_PUSH);
+    break;
+  case 'R':
+    MNEMONIC("RET", MNEM_RET);
+    break;
+  case 'S':
+    MNEMONIC("SUB", MNEM_SUB);
+    MNEMONIC("SHL", MNEM_SHL);
+    MNEMONIC("SHR", MNEM_SHR);
+    MNEMONIC("STOR", MNEM_STOR);
+    break;
+  case 'X':
+    MNEMONIC("XOR", MNEM_XOR);
+    break;
+  default:
+    break;
+  }
+
+  return MNEM_NONE;
+}
+
+int instruction_is_mnemonic(const char *word, const size_t len) {
+  if (!word) {
+    return 0;
   }
 
-  return 0;
+  return instruction_mnemonic_id(word, len ? len : strlen(word)) != MNEM_NONE;
 }
 
 const struct Instruction_Descriptor *instruction_find(const char *mnemonic,
                                                       const size_t len,
                                                       enum Operand_Type op1,
                                                       enum Operand_Type op2) {
-  size_t i = 0, i_len = 0, w_len = 0;
   if (!mnemonic) {
     return NULL;
   }
 
-  w_len = len;
-  if (len == 0) {
-    w_len = strlen(mnemonic);
-  }
+  return instruction_find_id(
+      instruction_mnemonic_id(mnemonic, len ? len : strlen(mnemonic)), op1,
+      op2);
+}
 
-  for (i = 0; i < INSTRUCTION_COUNT; i++) {
-    i_len = strlen(INSTRUCTION_TABLE[i].mnemonic);
-    if (w_len != i_len) {
-      continue; // skip different-length instructions
-    }
-    if (strncmp(INSTRUCTION_TABLE[i].mnemonic, mnemonic, w_len) == 0 &&
-        INSTRUCTION_TABLE[i].operand1 == op1 &&
-        INSTRUCTION_TABLE[i].operand2 == op2) {
-      return &INSTRUCTION_TABLE[i]; // Has the same mnemonic & both operands
-    }
+const struct Instruction_Descriptor *
+instruction_find_id(enum Mnemonic id, enum Operand_Type op1,
+                    enum Operand_Type op2) {
+  const struct Instruction_Descriptor *desc = NULL;
+  if (id <= MNEM_NONE || id >= MNEM_COUNT || op1 >= OP_TYPE_COUNT ||
+      op2 >= OP_TYPE_COUNT) {
+    return NULL;
   }
 
-  return NULL; // didn't found match
+  desc = &INSTRUCTION_TABLE[id][op1][op2];
+  return desc->mnemonic ? desc : NULL; // NULL if combination doesn't exist
 }
 
 size_t instruction_get_encoded_size(const struct Instruction_Descriptor *desc) {
@@ -140,6 +219,9 @@ size_t instruction_get_encoded_size(const struct Instruction_Descriptor *desc) {
   if (!desc) {
     return 0;
   }
+  if (desc->size) {
+    return desc->size; // all descriptors from the table have it precomputed
+  }
 
   if (desc->operand1 == OP_REG) {
     size += 1; // sizes of REG or immediate values are defined in assignment
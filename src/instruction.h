@@ -9,6 +9,62 @@ enum Operand_Type {
   OP_NONE,
   OP_REG,
   OP_IMM32, // immediate 32 bit value
+  OP_TYPE_COUNT
+};
+
+// Every mnemonic of KM processor. MNEM_NONE means word is not a mnemonic.
+enum Mnemonic {
+  MNEM_NONE = 0,
+  MNEM_HALT,
+  MNEM_NOP,
+  MNEM_MOV,
+  MNEM_MOVSD,
+  MNEM_LOAD,
+  MNEM_STOR,
+  MNEM_PUSH,
+  MNEM_POP,
+  MNEM_ADD,
+  MNEM_SUB,
+  MNEM_MUL,
+  MNEM_DIV,
+  MNEM_INC,
+  MNEM_DEC,
+  MNEM_AND,
+  MNEM_OR,
+  MNEM_XOR,
+  MNEM_NOT,
+  MNEM_SHL,
+  MNEM_SHR,
+  MNEM_CMP,
+  MNEM_JMP,
+  MNEM_JE,
+  MNEM_JNE,
+  MNEM_JG,
+  MNEM_JGE,
+  MNEM_JNG,
+  MNEM_JL,
+  MNEM_JLE,
+  MNEM_JNL,
+  MNEM_CALL,
+  MNEM_RET,
+  MNEM_OUTD,
+  MNEM_OUTC,
+  MNEM_OUTS,
+  MNEM_INPD,
+  MNEM_INPC,
+  MNEM_INPS,
+  MNEM_COUNT
+};
+
+// Registers of KM processor, the value is the encoded register code.
+enum Register_Code {
+  REG_A = 0,
+  REG_B,
+  REG_C,
+  REG_D,
+  REG_S,
+  REG_SP,
+  REG_COUNT
 };
 
 struct Instruction_Descriptor {
@@ -17,8 +73,14 @@ struct Instruction_Descriptor {
   enum Operand_Type operand1;
   enum Operand_Type operand2;
   int operand_count; // 0,1,2
+  enum Mnemonic id;  // the same as mnemonic, but without string compare
+  size_t size;       // encoded size in bytes, 0 if not precomputed
 };
 
+// Get ID of mnemonic in first len characters of word, without going through
+// the whole instruction table. Return MNEM_NONE if word is not a mnemonic.
+enum Mnemonic instruction_mnemonic_id(const char *word, const size_t len);
+
 // Check if given string is an instruction mnemonic.
 // If len == 0 word must be NULL-terminated, if len is specified,
 // uses it inside strncpy. Return 1 if is instruction, 0 if not.
@@ -32,6 +94,12 @@ const struct Instruction_Descriptor *instruction_find(const char *mnemonic,
                                                       enum Operand_Type op1,
                                                       enum Operand_Type op2);
 
+// Find I_D for given mnemonic ID and types of operands.
+// Return pointer to descriptor or NULL.
+const struct Instruction_Descriptor *
+instruction_find_id(enum Mnemonic id, enum Operand_Type op1,
+                    enum Operand_Type op2);
+
 // Calculate the size of an encoded instruction in bytes,
 size_t instruction_get_encoded_size(const struct Instruction_Descriptor *desc);
 
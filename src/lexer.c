@@ -1,5 +1,7 @@
 #include <ctype.h>
+#include <limits.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -7,6 +9,7 @@
 #include "instruction.h"
 #include "lexer.h"
 #include "memory.h"
+#include "symbol.h"
 
 #define TOKENS_INITIAL_CAPACITY 16
 #define TOKENS_CAPACITY_MULT 2
@@ -17,12 +20,14 @@ struct Token_Arr {
   struct Token *tokens;
   size_t count;
   size_t capacity;
+  struct Jarena *arena; // tokens are allocated from, NULL for jalloc
 };
 
 // ===== MACROS =====
 
-#define IDENTIFY(ch, type)                                                     \
-  if (num == sizeof(ch) - 1 && strncmp(word, (ch), num) == 0) {                \
+#define IDENTIFY(ch, type, word_id)                                            \
+  if (num == sizeof(ch) - 1 && memcmp(word, (ch), num) == 0) {                 \
+    *id = (word_id);                                                           \
     return (type);                                                             \
   }
 
@@ -30,9 +35,9 @@ struct Token_Arr {
 
 static const char *token_type_to_str(enum Token_Type type);
 
-// Initialize the insides of token array.
+// Initialize the insides of token array, allocated from arena (may be NULL).
 // Return 1 on success, 0 on failure.
-static int _tkar_init(struct Token_Arr *arr);
+static int _tkar_init(struct Token_Arr *arr, struct Jarena *arena);
 
 // Free all insides of token array.
 static void _tkar_deinit(struct Token_Arr *arr);
@@ -55,95 +60,121 @@ static int _lexer_set_next_token(struct Token *token, const char *line,
                                  const size_t len, size_t *pos,
                                  const size_t nl);
 
-// Update token to have given parameters.
-// Value can be NULL, in that case a token->value is irrelevant.
+// Update token to view single character c of the line.
 // Return 1 on success, 0 on failure.
-static int _lexer_set_token(struct Token *token, const enum Token_Type type,
-                            const char *value, const size_t nl);
-
-// Update token to have given parameters.
-// DOESN'T SUPPORT 0-length value!
-// Only uses first len characters from given value = good for non-NULL
-// terminated strings. It terminates the token->value by itself! Set Return 1 on
-// success, 0 on failure.
-static int _lexer_set_token_len(struct Token *token, const enum Token_Type type,
-                                const char *value, const size_t nl,
-                                const size_t len);
+static int _lexer_set_token_char(struct Token *token,
+                                 const enum Token_Type type, const char *c,
+                                 const size_t nl);
+
+// Compute the value of number in text, saturate on int64 overflow.
+// Text must be valid number (optional minus sign and digits).
+static int64_t _lexer_number_value(const char *text, const size_t len);
 
 // The string in DATA segments. Takes pointer AFTER first QUOTE.
+// At most max characters are available from s.
 // Update the given token to have all info.
 // Return 1 on success, 0 on failure.
 static int _lexer_set_token_string(struct Token *token, const char *s,
-                                   const size_t nl);
+                                   const size_t max, const size_t nl);
 
-// Take pointer to the '@'.
+// Take pointer to the '@', at most max characters are available from s.
 // Set token to updated values.
 // Return 1 on success, 0 on failure.
 static int _lexer_set_token_label(struct Token *token, const char *s,
-                                  const size_t nl);
+                                  const size_t max, const size_t nl);
 
-// Take pointer to first digit (or minus sign).
-// Set token for static number, found in code.
+// Take pointer to first digit (or minus sign), at most max characters are
+// available from s. Set token for static number, found in code.
 // Return 1 on success, 0 on failure.
 static int _lexer_set_token_number(struct Token *token, const char *s,
-                                   const size_t nl);
+                                   const size_t max, const size_t nl);
 
-// Take pointer to first letter.
+// Take pointer to first letter, at most max characters are available from s.
 // Distinguish between different words and set token to the one which it is.
 // Return 1 on success, 0 on failure.
 static int _lexer_set_token_word(struct Token *token, const char *s,
-                                 const size_t nl);
+                                 const size_t max, const size_t nl);
 
-// Classify the first <num> number of characters of word.
+// Classify the first <num> number of characters of word, and set its id
+// (see struct Token). Only words starting with the same character are
+// compared, mnemonics are left to instruction_mnemonic_id.
 // Return the adequate TokenType, or TOKEN_UNKNOWN if any error.
-static enum Token_Type _lexer_classify_word(const char *word, const size_t num);
+static enum Token_Type _lexer_classify_word(const char *word, const size_t num,
+                                            int *id);
+
+// Intern the name of TOKEN_LABEL or TOKEN_IDENTIFIER into symtab and set its
+// id to the symbol id, other tokens are left as they are.
+// Return 1 on success, 0 on failure.
+static int _lexer_intern(struct Token *token, struct Symbol_Table *symtab);
+
+// Tokenize line into token array allocated from arena, or by jalloc if arena
+// is NULL. See lexer_tokenize_span & lexer_tokenize_arena.
+static struct Token *_lexer_tokenize(struct Jarena *arena, const char *line,
+                                     const size_t len, const size_t nl,
+                                     struct Symbol_Table *symtab);
 
 // ===== PUBLIC FUNCTIONS =====
 
 struct Token *lexer_tokenize_line(const char *line, const size_t nl) {
-  struct Token_Arr arr = {0};
-  struct Token *token = NULL;
-  size_t pos = 0;
-  size_t len = 0;
-
   if (!line) {
     return NULL;
   }
 
-  CLEANUP_IF_FAIL(_tkar_init(&arr));
-
-  len = strlen(line);
+  return lexer_tokenize_span(line, strlen(line), nl, NULL);
+}
 
-  // Process the whole line
-  while (_lexer_skip_to_next_token(line, len, &pos)) {
-    CLEANUP_IF_FAIL(_tkar_ensure_capacity(&arr, 1));
-    token = &arr.tokens[arr.count];
+struct Token *lexer_tokenize_span(const char *line, const size_t len,
+                                  const size_t nl,
+                                  struct Symbol_Table *symtab) {
+  return _lexer_tokenize(NULL, line, len, nl, symtab);
+}
 
-    CLEANUP_IF_FAIL(_lexer_set_next_token(token, line, len, &pos, nl));
-    arr.count++;
+struct Token *lexer_tokenize_arena(struct Jarena *arena, const char *line,
+                                   const size_t len, const size_t nl,
+                                   struct Symbol_Table *symtab) {
+  RETURN_IF_FAIL(arena, NULL);
+  return _lexer_tokenize(arena, line, len, nl, symtab);
+}
 
-    token = NULL;
+void lexer_free_tokens(struct Token *tokens) {
+  if (tokens) {
+    jree(tokens);
   }
+  return;
+}
 
-  // Add EOF to the end
-  CLEANUP_IF_FAIL(_tkar_ensure_capacity(&arr, 1));
-  token = &arr.tokens[arr.count];
+int lexer_token_init(struct Token *token, const enum Token_Type type,
+                     const char *text, const size_t len, const size_t nl) {
+  CLEANUP_IF_FAIL(token && (text || len == 0));
 
-  CLEANUP_IF_FAIL(_lexer_set_token(token, TOKEN_EOF, NULL, nl));
-  arr.count++;
+  token->type = type;
+  token->text = text;
+  token->len = len;
+  token->line_number = nl;
+  token->number = 0;
+  token->id = 0;
+  if (type == TOKEN_LABEL || type == TOKEN_IDENTIFIER) {
+    token->id = TOKEN_NO_ID;
+  } else if (type == TOKEN_NUMBER && len > 0) {
+    token->number = _lexer_number_value(text, len);
+  } else if ((type == TOKEN_INSTRUCTION || type == TOKEN_REGISTER ||
+              type == TOKEN_DATA_TYPE) &&
+             len > 0) {
+    (void)_lexer_classify_word(text, len, &token->id);
+  }
 
-  return arr.tokens;
+  return 1;
 
 cleanup:
-  _tkar_deinit(&arr);
-  return NULL;
+  return 0;
 }
 
-void lexer_free_tokens(struct Token *tokens) {
-  if (tokens) {
-    jree(tokens);
-  }
-  return;
+int lexer_token_eq(const struct Token *token, const char *s) {
+  size_t len = 0;
+  RETURN_IF_FAIL(token && s, 0);
+
+  len = strlen(s);
+  return token->len == len && (len == 0 || memcmp(token->text, s, len) == 0);
 }
 
 void print_token(const struct Token *token) {
@@ -152,8 +183,9 @@ void print_token(const struct Token *token) {
     return;
   }
 
-  printf("Token{ type=%s, value=\"%s\", line=%zu }\n",
-         token_type_to_str(token->type), token->value, token->line_number);
+  printf("Token{ type=%s, value=\"%.*s\", line=%zu }\n",
+         token_type_to_str(token->type), (int)token->len,
+         token->text ? token->text : "", token->line_number);
 }
 
 void print_tokens(const struct Token *tokens) {
@@ -210,15 +242,63 @@ static const char *token_type_to_str(enum Token_Type type) {
   case TOKEN_EOF:
     return "EOF";
   case TOKEN_UNKNOWN:
+  case TOKEN_TYPE_COUNT:
   default:
     return "UNKNOWN";
   }
 }
 
-static int _tkar_init(struct Token_Arr *arr) {
+static struct Token *_lexer_tokenize(struct Jarena *arena, const char *line,
+                                     const size_t len, const size_t nl,
+                                     struct Symbol_Table *symtab) {
+  struct Token_Arr arr = {0};
+  struct Token *token = NULL;
+  size_t pos = 0;
+
+  if (!line) {
+    return NULL;
+  }
+
+  CLEANUP_IF_FAIL(_tkar_init(&arr, arena));
+
+  // Process the whole line
+  while (_lexer_skip_to_next_token(line, len, &pos)) {
+    CLEANUP_IF_FAIL(_tkar_ensure_capacity(&arr, 1));
+    token = &arr.tokens[arr.count];
+
+    CLEANUP_IF_FAIL(_lexer_set_next_token(token, line, len, &pos, nl));
+    if (symtab) {
+      CLEANUP_IF_FAIL(_lexer_intern(token, symtab));
+    }
+    arr.count++;
+
+    token = NULL;
+  }
+
+  // Add EOF to the end
+  CLEANUP_IF_FAIL(_tkar_ensure_capacity(&arr, 1));
+  token = &arr.tokens[arr.count];
+
+  CLEANUP_IF_FAIL(lexer_token_init(token, TOKEN_EOF, line + len, 0, nl));
+  arr.count++;
+
+  return arr.tokens;
+
+cleanup:
+  _tkar_deinit(&arr);
+  return NULL;
+}
+
+static int _tkar_init(struct Token_Arr *arr, struct Jarena *arena) {
   CLEANUP_IF_FAIL(arr);
 
-  arr->tokens = jalloc(TOKENS_INITIAL_CAPACITY * sizeof(struct Token));
+  arr->arena = arena;
+  if (arena) { // every token is set by lexer, no need to zero
+    arr->tokens =
+        jarena_alloc_raw(arena, TOKENS_INITIAL_CAPACITY * sizeof(struct Token));
+  } else {
+    arr->tokens = jalloc(TOKENS_INITIAL_CAPACITY * sizeof(struct Token));
+  }
   CLEANUP_IF_FAIL(arr->tokens);
 
   arr->count = 0;
@@ -233,9 +313,10 @@ cleanup:
 static void _tkar_deinit(struct Token_Arr *arr) {
   CLEANUP_IF_FAIL(arr);
 
-  if (arr->tokens) {
-    jree_clear((void **)&arr->tokens);
+  if (arr->tokens && !arr->arena) { // arena releases its memory on reset
+    jree(arr->tokens);
   }
+  arr->tokens = NULL;
   arr->count = 0;
   arr->capacity = 0;
 
@@ -263,7 +344,13 @@ static int _tkar_ensure_capacity(struct Token_Arr *arr,
     new_cap *= TOKENS_CAPACITY_MULT;
   }
 
-  new_tokens = jealloc(arr->tokens, new_cap * sizeof(struct Token));
+  if (arr->arena) {
+    new_tokens = jarena_grow(arr->arena, arr->tokens,
+                             arr->capacity * sizeof(struct Token),
+                             new_cap * sizeof(struct Token));
+  } else {
+    new_tokens = jealloc(arr->tokens, new_cap * sizeof(struct Token));
+  }
   CLEANUP_IF_FAIL(new_tokens);
 
   arr->tokens = new_tokens;
@@ -311,56 +398,60 @@ static int _lexer_set_next_token(struct Token *token, const char *line,
   // Single-character tokens
   if (*current == ',') {
     (*pos)++;
-    return _lexer_set_token(token, TOKEN_COMMA, ",", nl);
+    return _lexer_set_token_char(token, TOKEN_COMMA, current, nl);
   }
 
   if (*current == '(') {
     (*pos)++;
-    return _lexer_set_token(token, TOKEN_LPAREN, "(", nl);
+    return _lexer_set_token_char(token, TOKEN_LPAREN, current, nl);
   }
 
   if (*current == ')') {
     (*pos)++;
-    return _lexer_set_token(token, TOKEN_RPAREN, ")", nl);
+    return _lexer_set_token_char(token, TOKEN_RPAREN, current, nl);
   }
 
   if (*current == '?') {
     (*pos)++;
-    return _lexer_set_token(token, TOKEN_QUESTION, "?", nl);
+    return _lexer_set_token_char(token, TOKEN_QUESTION, current, nl);
   }
 
   // String literal in .DATA segment
   if (*current == '"') {
     CLEANUP_IF_FAIL(_lexer_set_token_string(token, current + 1,
+                                            len - *pos - 1,
                                             nl)); // +1 for opening quote
-    (*pos) += strlen(token->value) + 2; // +2 for the quotes on begin/end
+    (*pos) += token->len + 2; // +2 for the quotes on begin/end
     return 1;
   }
 
   // Label (starts with @)
   if (*current == '@') {
-    CLEANUP_IF_FAIL(_lexer_set_token_label(token, current, nl));
-    (*pos) += strlen(token->value) + 1; // +1 for ':'
+    CLEANUP_IF_FAIL(_lexer_set_token_label(token, current, len - *pos, nl));
+    (*pos) += token->len;
+    if (*pos < len && line[*pos] == ':') { // label definition
+      (*pos)++;
+    }
     return 1;
   }
 
   // Number (digit or negative number)
   if (isdigit(*current) ||
       (*current == '-' && *pos + 1 < len && isdigit(*(current + 1)))) {
-    CLEANUP_IF_FAIL(_lexer_set_token_number(token, current, nl));
-    (*pos) += strlen(token->value);
+    CLEANUP_IF_FAIL(_lexer_set_token_number(token, current, len - *pos, nl));
+    (*pos) += token->len;
     return 1;
   }
 
   // Word (instruction, register, keyword, or identifier)
   if (isalpha(*current) || *current == '.') {
-    CLEANUP_IF_FAIL(_lexer_set_token_word(token, current, nl));
-    (*pos) += strlen(token->value);
+    CLEANUP_IF_FAIL(_lexer_set_token_word(token, current, len - *pos, nl));
+    (*pos) += token->len;
     return 1;
   }
 
   // Unknown character
-  CLEANUP_IF_FAIL(_lexer_set_token_len(token, TOKEN_UNKNOWN, current, nl, 1));
+  CLEANUP_IF_FAIL(_lexer_set_token_char(token, TOKEN_UNKNOWN, current, nl));
   (*pos)++;
   return 1;
 
@@ -369,59 +460,57 @@ cleanup:
   return 0;
 }
 
-static int _lexer_set_token(struct Token *token, const enum Token_Type type,
-                            const char *value, const size_t nl) {
-  size_t val_len = 0;
-
-  CLEANUP_IF_FAIL(token);
-
-  token->type = type;
-  token->line_number = nl;
-  if (!value) { // allow NULL in value
-    return 1;
-  }
-
-  val_len = strlen(value);
-  CLEANUP_IF_FAIL(val_len + 1 <= TOKEN_MAX_VALUE_LEN);
-
-  memcpy(token->value, value, val_len);
-  token->value[val_len] = '\0';
-
-  return 1;
-
-cleanup:
-  return 0;
+static int _lexer_set_token_char(struct Token *token,
+                                 const enum Token_Type type, const char *c,
+                                 const size_t nl) {
+  return lexer_token_init(token, type, c, 1, nl);
 }
 
-static int _lexer_set_token_len(struct Token *token, const enum Token_Type type,
-                                const char *value, const size_t nl,
-                                const size_t len) {
-  CLEANUP_IF_FAIL(token && value && len > 0 && len + 1 <= TOKEN_MAX_VALUE_LEN);
+static int64_t _lexer_number_value(const char *text, const size_t len) {
+  size_t i = 0;
+  int negative = 0;
+  uint64_t res = 0, limit = (uint64_t)INT64_MAX, cutoff = 0, cutlim = 0;
+  if (!text || len == 0) {
+    return 0;
+  }
 
-  token->type = type;
-  token->line_number = nl;
-  memcpy(token->value, value, len);
-  token->value[len] = '\0';
+  if (text[0] == '-') {
+    negative = 1;
+    limit++; // |INT64_MIN| is one more than INT64_MAX
+    i++;
+  }
+  // overflow bounds are computed once, the loop is one multiply-add per digit
+  cutoff = limit / 10;
+  cutlim = limit % 10;
 
-  return 1;
+  for (; i < len; i++) {
+    const uint64_t digit = (uint64_t)(unsigned char)text[i] - '0';
+    if (res > cutoff || (res == cutoff && digit > cutlim)) {
+      return negative ? INT64_MIN : INT64_MAX; // saturate
+    }
+    res = res * 10 + digit;
+  }
 
-cleanup:
-  return 0;
+  if (negative) {
+    return (res == limit) ? INT64_MIN : -(int64_t)res;
+  }
+  return (int64_t)res;
 }
 
 static int _lexer_set_token_string(struct Token *token, const char *s,
-                                   const size_t nl) {
+                                   const size_t max, const size_t nl) {
   size_t n_chars = 0;
   const char *curr = s;
   CLEANUP_IF_FAIL(token && s);
 
-  while (*curr && *curr != '"') {
+  while (n_chars < max && *curr != '"') {
     n_chars++;
     curr++;
   }
-  CLEANUP_IF_FAIL(*curr); // strings end wasnt reached due to '\0'
+  CLEANUP_IF_FAIL(n_chars < max); // strings end wasnt reached due to EOL
+  CLEANUP_IF_FAIL(n_chars > 0);   // empty string is not supported
 
-  CLEANUP_IF_FAIL(_lexer_set_token_len(token, TOKEN_STRING, s, nl, n_chars));
+  CLEANUP_IF_FAIL(lexer_token_init(token, TOKEN_STRING, s, n_chars, nl));
 
   return 1;
 
@@ -430,21 +519,21 @@ cleanup:
 }
 
 static int _lexer_set_token_label(struct Token *token, const char *s,
-                                  const size_t nl) {
+                                  const size_t max, const size_t nl) {
   size_t n_chars = 0;
   const char *curr = s;
-  CLEANUP_IF_FAIL(token && s && *s == '@');
+  CLEANUP_IF_FAIL(token && s && max > 0 && *s == '@');
   n_chars++; // the @ at the beginning
   curr++;
 
-  while (*curr && (isalnum(*curr) || *curr == '_')) {
+  while (n_chars < max && (isalnum(*curr) || *curr == '_')) {
     n_chars++;
     curr++;
   }
 
   CLEANUP_IF_FAIL(n_chars >= 2); // too little characters
 
-  CLEANUP_IF_FAIL(_lexer_set_token_len(token, TOKEN_LABEL, s, nl, n_chars));
+  CLEANUP_IF_FAIL(lexer_token_init(token, TOKEN_LABEL, s, n_chars, nl));
 
   return 1;
 
@@ -453,17 +542,17 @@ cleanup:
 }
 
 static int _lexer_set_token_number(struct Token *token, const char *s,
-                                   const size_t nl) {
+                                   const size_t max, const size_t nl) {
   size_t n_chars = 0;
   const char *curr = s;
-  CLEANUP_IF_FAIL(token && s);
+  CLEANUP_IF_FAIL(token && s && max > 0);
 
   if (*curr == '-') { // optional negative number
     n_chars++;
     curr++;
   }
 
-  while (isdigit(*curr)) {
+  while (n_chars < max && isdigit(*curr)) {
     n_chars++;
     curr++;
   }
@@ -471,7 +560,7 @@ static int _lexer_set_token_number(struct Token *token, const char *s,
   CLEANUP_IF_FAIL((n_chars > 1 && *s == '-') ||
                   (n_chars > 0)); // too little chars
 
-  CLEANUP_IF_FAIL(_lexer_set_token_len(token, TOKEN_NUMBER, s, nl, n_chars));
+  CLEANUP_IF_FAIL(lexer_token_init(token, TOKEN_NUMBER, s, n_chars, nl));
 
   return 1;
 
@@ -480,24 +569,25 @@ cleanup:
 }
 
 static int _lexer_set_token_word(struct Token *token, const char *s,
-                                 const size_t nl) {
+                                 const size_t max, const size_t nl) {
   size_t n_chars = 0;
   const char *curr = s;
-  enum Token_Type type = TOKEN_UNKNOWN;
-  CLEANUP_IF_FAIL(token && s);
+  CLEANUP_IF_FAIL(token && s && max > 0);
 
-  if (*curr && *curr == '.') {
+  if (*curr == '.') {
     n_chars++;
     curr++;
   }
 
-  while (*curr && (isalnum(*curr) || *curr == '_')) {
+  while (n_chars < max && (isalnum(*curr) || *curr == '_')) {
     n_chars++;
     curr++;
   }
 
-  type = _lexer_classify_word(s, n_chars);
-  CLEANUP_IF_FAIL(_lexer_set_token_len(token, type, s, nl, n_chars));
+  CLEANUP_IF_FAIL(n_chars > 0);
+  // classify only once, init as plain identifier and then set real type
+  CLEANUP_IF_FAIL(lexer_token_init(token, TOKEN_IDENTIFIER, s, n_chars, nl));
+  token->type = _lexer_classify_word(s, n_chars, &token->id);
 
   return 1;
 
@@ -505,34 +595,68 @@ cleanup:
   return 0;
 }
 
-static enum Token_Type _lexer_classify_word(const char *word,
-                                            const size_t num) {
-  if (!word || num == 0) {
+static enum Token_Type _lexer_classify_word(const char *word, const size_t num,
+                                            int *id) {
+  enum Mnemonic mnemonic = MNEM_NONE;
+  if (!word || num == 0 || !id) {
     return TOKEN_UNKNOWN;
   }
-  // SECTION MARKER
-  IDENTIFY(".KMA", TOKEN_KMA);
-  IDENTIFY(".DATA", TOKEN_SECTION_DATA);
-  IDENTIFY(".CODE", TOKEN_SECTION_CODE);
-  // DATA TYPE
-  IDENTIFY("DW", TOKEN_DATA_TYPE);
-  IDENTIFY("DWORD", TOKEN_DATA_TYPE);
-  IDENTIFY("DB", TOKEN_DATA_TYPE);
-  IDENTIFY("BYTE", TOKEN_DATA_TYPE);
-  // REGISTERS
-  IDENTIFY("A", TOKEN_REGISTER);
-  IDENTIFY("B", TOKEN_REGISTER);
-  IDENTIFY("C", TOKEN_REGISTER);
-  IDENTIFY("D", TOKEN_REGISTER);
-  IDENTIFY("S", TOKEN_REGISTER);
-  IDENTIFY("SP", TOKEN_REGISTER);
+  *id = 0;
+
+  // every keyword is decided by its first character and length
+  switch (word[0]) {
+  case '.': // SECTION MARKER
+    IDENTIFY(".KMA", TOKEN_KMA, 0);
+    IDENTIFY(".DATA", TOKEN_SECTION_DATA, 0);
+    IDENTIFY(".CODE", TOKEN_SECTION_CODE, 0);
+    break;
+  case 'A':
+    IDENTIFY("A", TOKEN_REGISTER, REG_A);
+    break;
+  case 'B':
+    IDENTIFY("B", TOKEN_REGISTER, REG_B);
+    IDENTIFY("BYTE", TOKEN_DATA_TYPE, KW_BYTE);
+    break;
+  case 'C':
+    IDENTIFY("C", TOKEN_REGISTER, REG_C);
+    break;
+  case 'D':
+    IDENTIFY("D", TOKEN_REGISTER, REG_D);
+    IDENTIFY("DW", TOKEN_DATA_TYPE, KW_DWORD);
+    IDENTIFY("DB", TOKEN_DATA_TYPE, KW_BYTE);
+    IDENTIFY("DUP", TOKEN_DUP, 0);
+    IDENTIFY("DWORD", TOKEN_DATA_TYPE, KW_DWORD);
+    break;
+  case 'O':
+    IDENTIFY("OFFSET", TOKEN_OFFSET, 0);
+    break;
+  case 'S':
+    IDENTIFY("S", TOKEN_REGISTER, REG_S);
+    IDENTIFY("SP", TOKEN_REGISTER, REG_SP);
+    break;
+  default:
+    break;
+  }
+
   // INSTRUCTIONS
-  if (instruction_is_mnemonic(word, num)) {
+  mnemonic = instruction_mnemonic_id(word, num);
+  if (mnemonic != MNEM_NONE) {
+    *id = (int)mnemonic;
     return TOKEN_INSTRUCTION;
   }
-  // SPECIALS
-  IDENTIFY("DUP", TOKEN_DUP);
-  IDENTIFY("OFFSET", TOKEN_OFFSET);
 
+  *id = TOKEN_NO_ID; // plain name, interned later (if ever)
   return TOKEN_IDENTIFIER;
 }
+
+static int _lexer_intern(struct Token *token, struct Symbol_Table *symtab) {
+  uint32_t id = 0;
+  if (token->type != TOKEN_LABEL && token->type != TOKEN_IDENTIFIER) {
+    return 1;
+  }
+
+  id = symtab_intern(symtab, token->text, token->len);
+  RETURN_IF_FAIL(id != UINT32_MAX && id <= INT_MAX, 0);
+  token->id = (int)id;
+  return 1;
+}
@@ -2,8 +2,10 @@
 #define LEXER_H
 
 #include <stddef.h>
+#include <stdint.h>
 
-#define TOKEN_MAX_VALUE_LEN 256
+#include "memory.h"
+#include "symbol.h"
 
 // All possible types of token.
 enum Token_Type {
@@ -24,24 +26,71 @@ enum Token_Type {
   TOKEN_LPAREN,
   TOKEN_RPAREN,
   TOKEN_EOF,
-  TOKEN_UNKNOWN
+  TOKEN_UNKNOWN,
+  TOKEN_TYPE_COUNT
 };
 
-// Representation of one token.
+// Id of TOKEN_LABEL and TOKEN_IDENTIFIER whose name wasn't interned, so it
+// can't be mistaken for symbol 0.
+#define TOKEN_NO_ID (-1)
+
+// Size keyword of TOKEN_DATA_TYPE, stored in its id.
+enum Data_Keyword {
+  KW_NONE = 0,
+  KW_DWORD, // DW or DWORD
+  KW_BYTE   // DB or BYTE
+};
+
+// Representation of one token. The text is NOT copied, it points into the
+// tokenized line, so the line must outlive its tokens.
 struct Token {
   enum Token_Type type;
-  char value[TOKEN_MAX_VALUE_LEN];
+  const char *text; // start of the token in line, NOT NULL-terminated
+  size_t len;       // number of characters in text
   size_t line_number;
+  int64_t number; // value of TOKEN_NUMBER (saturated on overflow), else 0
+  int id; // enum Mnemonic of TOKEN_INSTRUCTION, enum Register_Code of
+          // TOKEN_REGISTER, enum Data_Keyword of TOKEN_DATA_TYPE, symbol id
+          // of interned TOKEN_LABEL and TOKEN_IDENTIFIER (TOKEN_NO_ID if
+          // not interned), else 0
 };
 
-// Tokenize given line (ended by \0).
+// Tokenize given line (ended by \0). Names aren't interned, their tokens get
+// TOKEN_NO_ID, so such lines can't be parsed (see parse_tokens).
 // Return pointer to array of tokens, ended by TOKEN_EOF, this array must be
 // later freed by calling lexer_free_tokens. Return NULL on failure.
 struct Token *lexer_tokenize_line(const char *line, const size_t nl);
 
+// Tokenize given line of exactly len characters (doesn't have to be ended by
+// \0, e.g. a view into mapped source). If symtab is not NULL, names of labels
+// and identifiers are interned into it (see symtab_intern) and their tokens
+// carry the symbol id. Same return values as lexer_tokenize_line.
+struct Token *lexer_tokenize_span(const char *line, const size_t len,
+                                  const size_t nl,
+                                  struct Symbol_Table *symtab);
+
+// Same as lexer_tokenize_span, but the token array is allocated from arena.
+// It must NOT be freed by lexer_free_tokens, it is released by resetting the
+// arena. Return NULL on failure.
+struct Token *lexer_tokenize_arena(struct Jarena *arena, const char *line,
+                                   const size_t len, const size_t nl,
+                                   struct Symbol_Table *symtab);
+
 // Free token array created by tokenizing one line.
 void lexer_free_tokens(struct Token *tokens);
 
+// Set the token to view first len characters of text (may be NULL if len is
+// 0). For TOKEN_NUMBER its value is computed right away, as is the id of
+// TOKEN_INSTRUCTION, TOKEN_REGISTER and TOKEN_DATA_TYPE. TOKEN_LABEL and
+// TOKEN_IDENTIFIER get TOKEN_NO_ID until interned.
+// Return 1 on success, 0 on failure.
+int lexer_token_init(struct Token *token, const enum Token_Type type,
+                     const char *text, const size_t len, const size_t nl);
+
+// Compare token text with NULL-terminated string s.
+// Return 1 if they are the same, 0 otherwise.
+int lexer_token_eq(const struct Token *token, const char *s);
+
 // Print one given token
 void print_token(const struct Token *token);
 
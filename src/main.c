@@ -1,4 +1,5 @@
 #include <assert.h>
+#include <stdint.h>
 #include <stdio.h>
 
 #include "args.h"
@@ -6,6 +7,7 @@
 #include "common.h"
 #include "memory.h"
 #include "output.h"
+#include "stats.h"
 
 #define DONT_FAIL(func)                                                        \
   do {                                                                         \
@@ -18,26 +20,41 @@ int main(const int argc, const char **argv) {
   struct Config config = {0};
   struct Assembler_Processing *asp = NULL;
   enum Err_Main err = ERR_NO_ERROR;
+  uint64_t t = 0;
+  log_init();
 
   // Parse arguments and save results into config.
   DONT_FAIL(args_parse(&config, argc, argv));
+  log_set_level(config.flag_verbose ? LOG_VERBOSE : LOG_INFO);
 
-  printf("Source: %s\nTarget: %s\nVerbose: %s\nInstructions: %s\n",
+  printf("Source: %s\nTarget: %s\nVerbose: %s\nInstructions: %s\n"
+         "Single pass: %s\nStats: %s\n",
          config.source, config.target, config.flag_verbose ? "yes" : "no",
-         config.flag_instruction ? "yes" : "no");
+         config.flag_instruction ? "yes" : "no",
+         config.flag_single_pass ? "yes" : "no",
+         config.flag_stats == STATS_JSON ? "json"
+         : config.flag_stats             ? "text"
+                                         : "no");
 
   asp = asp_create(&config, NULL, NULL, NULL);
   if (!asp) {
-    return -1; // placeholder
+    err = ERR_OUT_OF_MEMORY;
+    goto finalize;
   }
 
   DONT_FAIL(process_assembler(asp));
 
+  t = stats_now();
   DONT_FAIL(output_binary(asp));
+  stats_lap(&asp->stats, STATS_OUTPUT, t);
+  stats_print(&asp->stats, (enum Stats_Format)config.flag_stats, stderr);
 
 // Free all main-related memory, check for leaks and end
 finalize:
+  asp_free(&asp);
   args_config_deinit(&config);
+  log_flush(); // on success as well as on error
+  jemory_report(stderr); // only with JEMORY_PROFILE
   assert(jemory() == 0);
   return err;
 }
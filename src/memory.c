@@ -6,9 +6,97 @@
 
 #include "memory.h"
 
+// One block of arena, its data follow right after the (aligned) header.
+struct Jarena_Block {
+  struct Jarena_Block *next;
+  size_t capacity; // bytes of data
+};
+
 static size_t alloc_count = 0;
 
-void *jalloc(const size_t bytes) {
+#ifdef JEMORY_PROFILE
+// Initial number of slots of the table of live allocations, a power of 2.
+#define JEMORY_LIVE_INITIAL_CAPACITY 1024
+
+// Size & site of one live profiled allocation. They are kept in a table aside
+// of the memory, so the caller gets exactly the pointer calloc returned.
+struct Jemory_Live {
+  const void *mem; // NULL if the slot is empty
+  size_t bytes;
+  size_t site; // index into sites
+};
+
+// Statistics of one call site of jalloc/jealloc.
+struct Jemory_Site {
+  const char *file;
+  int line;
+  size_t allocs; // calls of jalloc
+  size_t bytes;  // allocated by jalloc plus grown by jealloc
+  size_t grows;  // calls of jealloc which made memory larger
+  size_t live;   // bytes allocated from here and not freed yet
+  size_t peak;   // maximum of live
+  int is_arena;  // bumped from arena, freed by reset, so live isn't known
+};
+
+static struct Jemory_Site sites[JEMORY_PROFILE_SITES];
+static size_t site_count = 0;
+static size_t live_bytes = 0, peak_bytes = 0;
+// open-addressing table of live allocations by their pointer
+static struct Jemory_Live *lives = NULL;
+static size_t live_count = 0, live_capacity = 0;
+
+// Find the site of file:line, add it if it's new. If the table is full, the
+// last site collects all the others. Return index of the site.
+static size_t _jemory_site(const char *file, const int line);
+
+// Account bytes as live at site, update peaks.
+static void _jemory_hold(const size_t site, const size_t bytes);
+
+// Account bytes of site as no longer live.
+static void _jemory_release(const size_t site, const size_t bytes);
+
+// Return the home slot of mem in the table of live allocations.
+static size_t _jemory_home(const void *mem);
+
+// Return the slot of mem, or the empty slot where it would be.
+static size_t _jemory_slot(const void *mem);
+
+// Remember bytes & site of mem, growing the table if needed.
+// Return 1 on success, 0 on failure.
+static int _jemory_track(const void *mem, const size_t bytes,
+                         const size_t site);
+
+// Forget the live allocation in slot, save its bytes & site into *live.
+static void _jemory_untrack(size_t slot, struct Jemory_Live *live);
+
+// Account arena allocation of bytes at file:line, which grew an earlier one
+// of old_bytes if old_bytes isn't 0.
+static void _jemory_bump(const char *file, const int line,
+                         const size_t old_bytes, const size_t bytes);
+
+// Compare sites by bytes, descending, for qsort.
+static int _jemory_site_cmp(const void *a, const void *b);
+#endif
+
+// Round size up to JARENA_ALIGN. Return SIZE_MAX on overflow.
+static size_t _jarena_align(const size_t size);
+
+// Return pointer to the data of block.
+static char *_jarena_data(struct Jarena_Block *block);
+
+// Bump bytes from the arena, NOT zeroed. Return pointer, NULL on failure.
+static void *_jarena_bump(struct Jarena *arena, const size_t bytes);
+
+// Move arena to the next block, which has at least bytes of data. Reuse the
+// next block in chain if it is large enough, otherwise insert a new one.
+// Return 1 on success, 0 on failure.
+static int _jarena_next_block(struct Jarena *arena, const size_t bytes);
+
+// Names in parentheses, so the profiling macros don't expand here.
+void *(jalloc)(const size_t bytes) {
+#ifdef JEMORY_PROFILE
+  return jalloc_at(bytes, "?", 0);
+#else
   void *mem = NULL;
   if (bytes == 0 || bytes > SIZE_MAX / 1) {
     return NULL;
@@ -19,9 +107,13 @@ void *jalloc(const size_t bytes) {
   }
   ++alloc_count;
   return mem;
+#endif
 }
 
-void *jealloc(void *src, const size_t bytes) {
+void *(jealloc)(void *src, const size_t bytes) {
+#ifdef JEMORY_PROFILE
+  return jealloc_at(src, bytes, "?", 0);
+#else
   void *mem = NULL;
   if (!src) {
     return NULL;
@@ -29,6 +121,7 @@ void *jealloc(void *src, const size_t bytes) {
   mem = realloc(src, bytes);
 
   return mem;
+#endif
 }
 
 void jree(void *memory) {
@@ -37,6 +130,18 @@ void jree(void *memory) {
   }
   assert(alloc_count > 0);
   --alloc_count;
+#ifdef JEMORY_PROFILE
+  {
+    struct Jemory_Live live = {0};
+    _jemory_untrack(_jemory_slot(memory), &live);
+    _jemory_release(live.site, live.bytes);
+    if (live_count == 0) { // nothing is left at exit
+      free(lives);
+      lives = NULL;
+      live_capacity = 0;
+    }
+  }
+#endif
   free(memory);
 }
 
@@ -73,3 +178,399 @@ char *jtrndup(const char *str, size_t size) {
   dup[size] = '\0';
   return dup;
 }
+
+// ===== ARENA =====
+
+int jarena_init(struct Jarena *arena, const size_t block_size) {
+  if (!arena) {
+    return 0;
+  }
+  arena->first = NULL;
+  arena->current = NULL;
+  arena->used = 0;
+  arena->block_size = block_size ? block_size : JARENA_BLOCK_SIZE;
+  arena->last = NULL;
+  return 1;
+}
+
+void jarena_deinit(struct Jarena *arena) {
+  struct Jarena_Block *block = NULL, *next = NULL;
+  if (!arena) {
+    return;
+  }
+  for (block = arena->first; block; block = next) {
+    next = block->next;
+    jree(block);
+  }
+  arena->first = NULL;
+  arena->current = NULL;
+  arena->used = 0;
+  arena->last = NULL;
+}
+
+void *(jarena_alloc)(struct Jarena *arena, const size_t bytes) {
+  void *mem = _jarena_bump(arena, bytes);
+  if (mem) {
+    memset(mem, 0, bytes);
+  }
+  return mem;
+}
+
+void *(jarena_alloc_raw)(struct Jarena *arena, const size_t bytes) {
+  return _jarena_bump(arena, bytes);
+}
+
+static void *_jarena_bump(struct Jarena *arena, const size_t bytes) {
+  size_t start = 0;
+  char *mem = NULL;
+  if (!arena || bytes == 0 || bytes > SIZE_MAX - JARENA_ALIGN) {
+    return NULL;
+  }
+
+  if (arena->current) {
+    start = _jarena_align(arena->used);
+  }
+  if (!arena->current || start > arena->current->capacity ||
+      bytes > arena->current->capacity - start) {
+    if (!_jarena_next_block(arena, bytes)) {
+      return NULL;
+    }
+    start = 0;
+  }
+
+  mem = _jarena_data(arena->current) + start;
+  arena->used = start + bytes;
+  arena->last = mem;
+  return mem;
+}
+
+void *(jarena_grow)(struct Jarena *arena, void *src, const size_t old_bytes,
+                    const size_t bytes) {
+  size_t start = 0;
+  void *mem = NULL;
+  if (!arena || bytes == 0) {
+    return NULL;
+  }
+  if (!src) {
+    return _jarena_bump(arena, bytes);
+  }
+
+  if (src == arena->last) { // nothing after it, can grow in place
+    start = (size_t)((char *)src - _jarena_data(arena->current));
+    if (bytes <= arena->current->capacity - start) {
+      arena->used = start + bytes;
+      return src;
+    }
+  }
+
+  mem = _jarena_bump(arena, bytes);
+  if (mem) {
+    memcpy(mem, src, old_bytes < bytes ? old_bytes : bytes);
+  }
+  return mem;
+}
+
+void jarena_mark(const struct Jarena *arena, struct Jarena_Mark *mark) {
+  if (!arena || !mark) {
+    return;
+  }
+  mark->block = arena->current;
+  mark->used = arena->used;
+}
+
+void jarena_reset(struct Jarena *arena, const struct Jarena_Mark *mark) {
+  if (!arena || !mark) {
+    return;
+  }
+  if (mark->block) {
+    arena->current = mark->block;
+    arena->used = mark->used;
+  } else { // taken before the first allocation
+    arena->current = arena->first;
+    arena->used = 0;
+  }
+  arena->last = NULL;
+}
+
+static size_t _jarena_align(const size_t size) {
+  if (size > SIZE_MAX - (JARENA_ALIGN - 1)) {
+    return SIZE_MAX;
+  }
+  return (size + (JARENA_ALIGN - 1)) & ~(size_t)(JARENA_ALIGN - 1);
+}
+
+static char *_jarena_data(struct Jarena_Block *block) {
+  return (char *)block + _jarena_align(sizeof(struct Jarena_Block));
+}
+
+static int _jarena_next_block(struct Jarena *arena, const size_t bytes) {
+  struct Jarena_Block *next = NULL;
+  size_t capacity = 0, header = _jarena_align(sizeof(struct Jarena_Block));
+
+  next = arena->current ? arena->current->next : arena->first;
+  if (!next || next->capacity < bytes) {
+    capacity = bytes > arena->block_size ? bytes : arena->block_size;
+    if (capacity > SIZE_MAX - header) {
+      return 0;
+    }
+    next = jalloc(header + capacity);
+    if (!next) {
+      return 0;
+    }
+    next->capacity = capacity;
+    if (arena->current) {
+      next->next = arena->current->next;
+      arena->current->next = next;
+    } else {
+      next->next = arena->first;
+      arena->first = next;
+    }
+  }
+
+  arena->current = next;
+  arena->used = 0;
+  return 1;
+}
+
+// ===== PROFILING =====
+
+#ifdef JEMORY_PROFILE
+void *jalloc_at(const size_t bytes, const char *file, const int line) {
+  void *mem = NULL;
+  size_t site = 0;
+  if (bytes == 0) {
+    return NULL;
+  }
+  mem = calloc(bytes, 1);
+  if (!mem) {
+    return NULL;
+  }
+  site = _jemory_site(file, line);
+  if (!_jemory_track(mem, bytes, site)) {
+    free(mem);
+    return NULL;
+  }
+  ++alloc_count;
+
+  sites[site].allocs++;
+  sites[site].bytes += bytes;
+  _jemory_hold(site, bytes);
+  return mem;
+}
+
+void *jealloc_at(void *src, const size_t bytes, const char *file,
+                 const int line) {
+  struct Jemory_Live old = {0};
+  void *mem = NULL;
+  size_t site = 0, slot = 0;
+  if (!src || bytes == 0) {
+    return NULL;
+  }
+  slot = _jemory_slot(src);
+  mem = realloc(src, bytes);
+  if (!mem) {
+    return NULL;
+  }
+  // slot of src is freed first, so tracking mem can't grow & fail
+  _jemory_untrack(slot, &old);
+  site = _jemory_site(file, line);
+  (void)_jemory_track(mem, bytes, site);
+
+  // the memory now belongs to the site which resized it
+  _jemory_release(old.site, old.bytes);
+  if (bytes > old.bytes) {
+    sites[site].grows++;
+    sites[site].bytes += bytes - old.bytes;
+  }
+  _jemory_hold(site, bytes);
+  return mem;
+}
+
+void *jarena_alloc_at(struct Jarena *arena, const size_t bytes,
+                      const char *file, const int line) {
+  void *mem = (jarena_alloc)(arena, bytes);
+  if (mem) {
+    _jemory_bump(file, line, 0, bytes);
+  }
+  return mem;
+}
+
+void *jarena_alloc_raw_at(struct Jarena *arena, const size_t bytes,
+                          const char *file, const int line) {
+  void *mem = (jarena_alloc_raw)(arena, bytes);
+  if (mem) {
+    _jemory_bump(file, line, 0, bytes);
+  }
+  return mem;
+}
+
+void *jarena_grow_at(struct Jarena *arena, void *src, const size_t old_bytes,
+                     const size_t bytes, const char *file, const int line) {
+  void *mem = (jarena_grow)(arena, src, old_bytes, bytes);
+  if (mem) {
+    _jemory_bump(file, line, src ? old_bytes : 0, bytes);
+  }
+  return mem;
+}
+
+void jemory_report(FILE *out) {
+  static struct Jemory_Site sorted[JEMORY_PROFILE_SITES];
+  size_t i = 0, allocs = 0, bumps = 0;
+  if (!out) {
+    return;
+  }
+
+  memcpy(sorted, sites, site_count * sizeof(struct Jemory_Site));
+  qsort(sorted, site_count, sizeof(struct Jemory_Site), _jemory_site_cmp);
+  for (i = 0; i < site_count; i++) {
+    if (sorted[i].is_arena) {
+      bumps += sorted[i].allocs;
+    } else {
+      allocs += sorted[i].allocs;
+    }
+  }
+
+  fprintf(out,
+          "Memory profile: %zu allocations (+%zu from arenas), "
+          "peak %zu B live\n",
+          allocs, bumps, peak_bytes);
+  fprintf(out, "%10s %12s %8s %12s  %s\n", "allocs", "bytes", "grows",
+          "peak live", "site");
+  for (i = 0; i < site_count; i++) {
+    fprintf(out, "%10zu %12zu %8zu ", sorted[i].allocs, sorted[i].bytes,
+            sorted[i].grows);
+    if (sorted[i].is_arena) { // inside of arena blocks counted at their site
+      fprintf(out, "%12s", "arena");
+    } else {
+      fprintf(out, "%12zu", sorted[i].peak);
+    }
+    fprintf(out, "  %s:%d\n", sorted[i].file, sorted[i].line);
+  }
+}
+
+static size_t _jemory_site(const char *file, const int line) {
+  size_t i = 0;
+  struct Jemory_Site *site = NULL;
+  for (i = 0; i < site_count; i++) {
+    if (sites[i].line == line && strcmp(sites[i].file, file) == 0) {
+      return i;
+    }
+  }
+
+  if (site_count == JEMORY_PROFILE_SITES) {
+    return JEMORY_PROFILE_SITES - 1;
+  }
+  site = &sites[site_count];
+  site->file = file;
+  site->line = line;
+  if (site_count == JEMORY_PROFILE_SITES - 1) { // collects the rest
+    site->file = "other";
+    site->line = 0;
+  }
+  return site_count++;
+}
+
+static void _jemory_hold(const size_t site, const size_t bytes) {
+  sites[site].live += bytes;
+  if (sites[site].live > sites[site].peak) {
+    sites[site].peak = sites[site].live;
+  }
+  live_bytes += bytes;
+  if (live_bytes > peak_bytes) {
+    peak_bytes = live_bytes;
+  }
+}
+
+static void _jemory_release(const size_t site, const size_t bytes) {
+  assert(sites[site].live >= bytes && live_bytes >= bytes);
+  sites[site].live -= bytes;
+  live_bytes -= bytes;
+}
+
+static size_t _jemory_home(const void *mem) {
+  uintptr_t key = (uintptr_t)mem >> 4; // low bits are alignment only
+  return (size_t)(key * 2654435761u) & (live_capacity - 1);
+}
+
+static size_t _jemory_slot(const void *mem) {
+  size_t i = 0;
+  assert(live_capacity > 0); // jree of memory not from jalloc
+  i = _jemory_home(mem);
+  while (lives[i].mem && lives[i].mem != mem) {
+    i = (i + 1) & (live_capacity - 1);
+  }
+  return i;
+}
+
+static int _jemory_track(const void *mem, const size_t bytes,
+                         const size_t site) {
+  struct Jemory_Live *old = lives;
+  size_t i = 0, old_capacity = live_capacity;
+
+  if ((live_count + 1) * 2 > live_capacity) { // keep at most half full
+    live_capacity =
+        old_capacity ? old_capacity * 2 : JEMORY_LIVE_INITIAL_CAPACITY;
+    lives = calloc(live_capacity, sizeof(struct Jemory_Live));
+    if (!lives) {
+      lives = old;
+      live_capacity = old_capacity;
+      return 0;
+    }
+    for (i = 0; i < old_capacity; i++) {
+      if (old[i].mem) {
+        lives[_jemory_slot(old[i].mem)] = old[i];
+      }
+    }
+    free(old);
+  }
+
+  i = _jemory_slot(mem);
+  lives[i].mem = mem;
+  lives[i].bytes = bytes;
+  lives[i].site = site;
+  live_count++;
+  return 1;
+}
+
+static void _jemory_untrack(size_t slot, struct Jemory_Live *live) {
+  size_t i = slot, j = 0, home = 0;
+  const size_t mask = live_capacity - 1;
+  assert(lives[i].mem != NULL);
+  *live = lives[i];
+  lives[i].mem = NULL;
+  live_count--;
+
+  // shift back the following entries which can't be found past the hole
+  for (j = (i + 1) & mask; lives[j].mem; j = (j + 1) & mask) {
+    home = _jemory_home(lives[j].mem);
+    if (((j - home) & mask) >= ((j - i) & mask)) {
+      lives[i] = lives[j];
+      lives[j].mem = NULL;
+      i = j;
+    }
+  }
+}
+
+static void _jemory_bump(const char *file, const int line,
+                         const size_t old_bytes, const size_t bytes) {
+  struct Jemory_Site *site = &sites[_jemory_site(file, line)];
+  site->is_arena = 1;
+  if (old_bytes == 0) {
+    site->allocs++;
+    site->bytes += bytes;
+  } else if (bytes > old_bytes) {
+    site->grows++;
+    site->bytes += bytes - old_bytes;
+  }
+}
+
+static int _jemory_site_cmp(const void *a, const void *b) {
+  const struct Jemory_Site *x = a, *y = b;
+  if (x->bytes != y->bytes) {
+    return x->bytes < y->bytes ? 1 : -1;
+  }
+  return x->allocs < y->allocs ? 1 : (x->allocs > y->allocs ? -1 : 0);
+}
+#else
+void jemory_report(FILE *out) { (void)out; }
+#endif
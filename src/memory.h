@@ -2,6 +2,36 @@
 #define JEMORY_H
 
 #include <stddef.h>
+#include <stdio.h>
+
+// Maximal number of distinct call sites the profiling keeps apart, the rest
+// is counted together as one "other" site.
+#define JEMORY_PROFILE_SITES 256
+
+// Every arena allocation is aligned to this many bytes.
+#define JARENA_ALIGN 16
+// Default size of one arena block. Larger allocations get a block of their
+// own size.
+#define JARENA_BLOCK_SIZE (64 * 1024)
+
+struct Jarena_Block;
+
+// Region for short-lived allocations, which are bump-allocated from blocks
+// and released all at once by resetting back to a mark. Blocks are allocated
+// via jalloc (so jemory counts them) and kept for reuse until jarena_deinit.
+struct Jarena {
+  struct Jarena_Block *first;   // chain of all blocks, in order of use
+  struct Jarena_Block *current; // block being bumped, NULL if there is none
+  size_t used;                  // bytes used in current block
+  size_t block_size;
+  void *last; // most recent allocation, only that one can grow in place
+};
+
+// Position in arena, see jarena_mark & jarena_reset.
+struct Jarena_Mark {
+  struct Jarena_Block *block;
+  size_t used;
+};
 
 // Somewhere/Somehow allocate these bytes.
 // If bytes == 0, return NULL and not alocate.
@@ -23,6 +53,11 @@ void jree_clear(void **memory_ptr);
 // Return how many allocations are active right now.
 size_t jemory(void);
 
+// Print per call site profile of jalloc & jealloc (and of arena allocations),
+// sorted by allocated bytes, into out. Only with JEMORY_PROFILE defined
+// (make PROFILE=1), otherwise prints nothing.
+void jemory_report(FILE *out);
+
 // My implementation of POSIX's strdup().
 // Returns a pointer to a null-terminated byte string, which is a duplicate of
 // the string pointed to by str1. On error return NULL.
@@ -35,4 +70,58 @@ char *jtrdup(const char *str1);
 // The caller must free!
 char *jtrndup(const char *str, size_t size);
 
+// Initialize an empty arena, no block is allocated yet. If block_size is 0,
+// JARENA_BLOCK_SIZE is used. Return 1 on success, 0 on failure.
+int jarena_init(struct Jarena *arena, const size_t block_size);
+
+// Free all blocks of the arena, every allocation from it is invalid.
+void jarena_deinit(struct Jarena *arena);
+
+// Allocate zeroed bytes from the arena. If bytes == 0, return NULL.
+// Return pointer on success, NULL on failure.
+void *jarena_alloc(struct Jarena *arena, const size_t bytes);
+
+// Same as jarena_alloc, but the memory is NOT zeroed.
+void *jarena_alloc_raw(struct Jarena *arena, const size_t bytes);
+
+// Arena version of jealloc: src (of old_bytes, may be NULL) now has <bytes>
+// number of bytes. The most recent allocation grows in place when its block
+// has room, others are copied, the old memory stays until reset. The new
+// bytes are NOT zeroed. Return new pointer on success, NULL on failure.
+void *jarena_grow(struct Jarena *arena, void *src, const size_t old_bytes,
+                  const size_t bytes);
+
+// Remember current position of the arena into *mark.
+void jarena_mark(const struct Jarena *arena, struct Jarena_Mark *mark);
+
+// Release everything allocated after the mark was taken. Blocks are kept, so
+// following allocations reuse them without calling jalloc.
+void jarena_reset(struct Jarena *arena, const struct Jarena_Mark *mark);
+
+#ifdef JEMORY_PROFILE
+// Profiled jalloc & jealloc, recording the call site. Use the macros below.
+void *jalloc_at(const size_t bytes, const char *file, const int line);
+void *jealloc_at(void *src, const size_t bytes, const char *file,
+                 const int line);
+
+#define jalloc(bytes) jalloc_at((bytes), __FILE__, __LINE__)
+#define jealloc(src, bytes) jealloc_at((src), (bytes), __FILE__, __LINE__)
+
+// Profiled arena allocations, recording the call site, as the arena blocks
+// alone would charge everything to one site. Use the macros below.
+void *jarena_alloc_at(struct Jarena *arena, const size_t bytes,
+                      const char *file, const int line);
+void *jarena_alloc_raw_at(struct Jarena *arena, const size_t bytes,
+                          const char *file, const int line);
+void *jarena_grow_at(struct Jarena *arena, void *src, const size_t old_bytes,
+                     const size_t bytes, const char *file, const int line);
+
+#define jarena_alloc(arena, bytes)                                             \
+  jarena_alloc_at((arena), (bytes), __FILE__, __LINE__)
+#define jarena_alloc_raw(arena, bytes)                                         \
+  jarena_alloc_raw_at((arena), (bytes), __FILE__, __LINE__)
+#define jarena_grow(arena, src, old_bytes, bytes)                              \
+  jarena_grow_at((arena), (src), (old_bytes), (bytes), __FILE__, __LINE__)
+#endif
+
 #endif
@@ -1,5 +1,331 @@
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200112L // posix_fallocate
+#endif
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#if defined(_WIN32)
+#include <process.h> // for _getpid WIN
+#define getpid _getpid
+#else
+#include <fcntl.h>   // for open, posix_fallocate UNIX
+#include <sys/uio.h> // for writev UNIX
+#include <unistd.h>  // for close, getpid UNIX
+#endif
+
+#include "codeseg.h"
+#include "common.h"
+#include "dataseg.h"
+#include "memory.h"
 #include "output.h"
 
+#define OUTPUT_BATCH 64 // parts written by one writev call
+// Bytes of a run written by one part, multiple of 4 so DWord runs stay aligned.
+#define OUTPUT_FILL_BLOCK 4096
+
+// One continuous part of the output file.
+struct Output_Part {
+  const uint8_t *bytes;
+  size_t size;
+};
+
+// File being written. Parts are collected and written in batches, so they
+// must stay valid until the next flush.
+struct Output_File {
+#if defined(_WIN32)
+  FILE *f;
+#else
+  int fd;
+#endif
+  struct Output_Part batch[OUTPUT_BATCH];
+  size_t count;
+};
+
+// ===== PRIVATE FUNCTION DECLARATIONS =====
+
+// Fill the KMX header for segments of given sizes.
+static void _output_header(uint8_t header[KMX_HEADER_SIZE], uint32_t code_size,
+                           uint32_t data_size, uint32_t bss_size);
+
+// Store value as little endian into dst.
+static void _output_le32(uint8_t *dst, uint32_t value);
+
+// Create name of temporary file next to target. Caller must free.
+// Return NULL on failure.
+static char *_output_tmp_name(const char *target);
+
+// Append first limit bytes of the data segment extent by extent, runs are
+// written from one block filled by their pattern, so they are never
+// materialized whole.
+// Return 1 on success, 0 on failure.
+static int _output_data(struct Output_File *out,
+                        const struct Data_Segment *dtsg, size_t limit);
+
+// Append part to the batch, flush the batch if it's full.
+// Return 1 on success, 0 on failure.
+static int _output_add(struct Output_File *out, const uint8_t *bytes,
+                       size_t size);
+
+// Create new file on path, its size is known beforehand.
+// Return 1 on success, 0 on failure.
+static int _output_open(struct Output_File *out, const char *path,
+                        size_t total);
+
+// Write all parts in the batch and empty it.
+// Return 1 on success, 0 on failure.
+static int _output_flush(struct Output_File *out);
+
+// Flush the rest of batch and close the file.
+// Return 1 on success, 0 on failure (the file may be left behind).
+static int _output_close(struct Output_File *out);
+
+// ===== PUBLIC FUNCTIONS =====
+
 enum Err_Main output_binary(const struct Assembler_Processing *asp) {
-  return asp == 2;
+  uint8_t header[KMX_HEADER_SIZE];
+  struct Output_File out;
+  size_t code_size = 0, data_size = 0, bss_size = 0;
+  char *tmp = NULL;
+  int ok = 0;
+  enum Err_Main err = ERR_NO_ERROR;
+  RETURN_IF_FAIL(asp && asp->config && asp->config->target && asp->cdsg &&
+                     asp->dtsg,
+                 ERR_INVALID_OUTPUT_FILE);
+
+  code_size = cdsg_get_size(asp->cdsg);
+  data_size = dtsg_get_size(asp->dtsg);
+  RETURN_IF_FAIL(asp->bss_size <= data_size, ERR_INVALID_OUTPUT_FILE);
+  bss_size = asp->bss_size;
+  data_size -= bss_size; // BSS isn't written, the loader zeroes it
+  RETURN_IF_FAIL(code_size <= UINT32_MAX, ERR_CODE_SEGMENT_TOO_LARGE);
+  RETURN_IF_FAIL(data_size <= UINT32_MAX, ERR_DATA_SEGMENT_TOO_LARGE);
+  RETURN_IF_FAIL(bss_size <= UINT32_MAX, ERR_DATA_SEGMENT_TOO_LARGE);
+  _output_header(header, (uint32_t)code_size, (uint32_t)data_size,
+                 (uint32_t)bss_size);
+
+  tmp = _output_tmp_name(asp->config->target);
+  RETURN_IF_FAIL(tmp, ERR_OUT_OF_MEMORY);
+
+  if (!_output_open(&out, tmp, KMX_HEADER_SIZE + code_size + data_size)) {
+    err = ERR_FILE_ACCESS_FAILURE;
+    goto cleanup;
+  }
+  // segments are written right from their buffers, nothing is copied
+  ok = _output_add(&out, header, KMX_HEADER_SIZE) &&
+       _output_add(&out, cdsg_get_bytes(asp->cdsg), code_size) &&
+       _output_data(&out, asp->dtsg, data_size);
+  if (!_output_close(&out) || !ok) {
+    err = ERR_FILE_ACCESS_FAILURE;
+    goto cleanup;
+  }
+#if defined(_WIN32)
+  remove(asp->config->target); // rename doesn't replace existing file on WIN
+#endif
+  if (rename(tmp, asp->config->target) != 0) {
+    err = ERR_INVALID_OUTPUT_FILE;
+    goto cleanup;
+  }
+
+  jree(tmp);
+  return ERR_NO_ERROR;
+
+cleanup:
+  remove(tmp);
+  jree(tmp);
+  return err;
 }
+
+// ===== PRIVATE FUNCTIONS =====
+
+static void _output_header(uint8_t header[KMX_HEADER_SIZE], uint32_t code_size,
+                           uint32_t data_size, uint32_t bss_size) {
+  memcpy(header, KMX_MAGIC, 3);
+  header[3] = KMX_VERSION;
+  _output_le32(header + 4, code_size);
+  _output_le32(header + 8, data_size);
+  _output_le32(header + 12, bss_size);
+}
+
+static void _output_le32(uint8_t *dst, uint32_t value) {
+  dst[0] = (uint8_t)(value & 0xFF);
+  dst[1] = (uint8_t)((value >> 8) & 0xFF);
+  dst[2] = (uint8_t)((value >> 16) & 0xFF);
+  dst[3] = (uint8_t)((value >> 24) & 0xFF);
+}
+
+static char *_output_tmp_name(const char *target) {
+  size_t len = 0;
+  char *tmp = NULL;
+  int written = 0;
+  RETURN_IF_FAIL(target, NULL);
+
+  len = strlen(target) + 32; // ".tmp" + pid
+  tmp = jalloc(len);
+  RETURN_IF_FAIL(tmp, NULL);
+
+  // pid makes the name unique among parallel builds of the same target
+  written = snprintf(tmp, len, "%s.tmp%ld", target, (long)getpid());
+  if (written < 0 || (size_t)written >= len) {
+    jree(tmp);
+    return NULL;
+  }
+  return tmp;
+}
+
+static int _output_data(struct Output_File *out,
+                        const struct Data_Segment *dtsg, size_t limit) {
+  uint8_t fill[OUTPUT_FILL_BLOCK];
+  struct Dtsg_Extent ext;
+  size_t i = 0, count = 0, left = 0, block = 0;
+  RETURN_IF_FAIL(out && dtsg, 0);
+
+  count = dtsg_get_extent_count(dtsg);
+  for (i = 0; i < count && limit > 0; i++) {
+    RETURN_IF_FAIL(dtsg_get_extent(dtsg, i, &ext), 0);
+    ext.length = ext.length < limit ? ext.length : limit;
+    limit -= ext.length;
+    if (ext.kind == DTSG_EXT_LITERAL) {
+      RETURN_IF_FAIL(_output_add(out, dtsg->bytes + ext.start, ext.length), 0);
+      continue;
+    }
+
+    // the fill block is reused, so the previous parts must be written first
+    RETURN_IF_FAIL(_output_flush(out), 0);
+    block = ext.length < OUTPUT_FILL_BLOCK ? ext.length : OUTPUT_FILL_BLOCK;
+    RETURN_IF_FAIL(dtsg_extent_fill(&ext, fill, block), 0);
+    for (left = ext.length; left > 0; left -= block) {
+      block = left < OUTPUT_FILL_BLOCK ? left : OUTPUT_FILL_BLOCK;
+      RETURN_IF_FAIL(_output_add(out, fill, block), 0);
+    }
+    RETURN_IF_FAIL(_output_flush(out), 0);
+  }
+  return 1;
+}
+
+static int _output_add(struct Output_File *out, const uint8_t *bytes,
+                       size_t size) {
+  RETURN_IF_FAIL(out, 0);
+
+  if (size == 0) {
+    return 1; // nothing to write
+  }
+  RETURN_IF_FAIL(bytes, 0);
+
+  if (out->count == OUTPUT_BATCH) {
+    RETURN_IF_FAIL(_output_flush(out), 0);
+  }
+  out->batch[out->count].bytes = bytes;
+  out->batch[out->count].size = size;
+  out->count++;
+  return 1;
+}
+
+#if defined(_WIN32)
+
+static int _output_open(struct Output_File *out, const char *path,
+                        size_t total) {
+  (void)total;
+  RETURN_IF_FAIL(out && path, 0);
+
+  out->count = 0;
+  out->f = fopen(path, "wb");
+  return out->f != NULL;
+}
+
+static int _output_flush(struct Output_File *out) {
+  size_t i = 0;
+  RETURN_IF_FAIL(out && out->f, 0);
+
+  for (i = 0; i < out->count; i++) {
+    if (fwrite(out->batch[i].bytes, 1, out->batch[i].size, out->f) !=
+        out->batch[i].size) {
+      return 0;
+    }
+  }
+  out->count = 0;
+  return 1;
+}
+
+static int _output_close(struct Output_File *out) {
+  int ok = 0;
+  RETURN_IF_FAIL(out && out->f, 0);
+
+  ok = _output_flush(out);
+  if (fclose(out->f) != 0) {
+    ok = 0;
+  }
+  out->f = NULL;
+  return ok;
+}
+
+#else
+
+static int _output_open(struct Output_File *out, const char *path,
+                        size_t total) {
+  RETURN_IF_FAIL(out && path, 0);
+
+  out->count = 0;
+  out->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  RETURN_IF_FAIL(out->fd >= 0, 0);
+
+  // reserve the whole file at once, filesystems without support are fine
+  errno = posix_fallocate(out->fd, 0, (off_t)total);
+  if (errno == ENOSPC || errno == EFBIG) {
+    close(out->fd);
+    out->fd = -1;
+    return 0;
+  }
+  return 1;
+}
+
+static int _output_flush(struct Output_File *out) {
+  struct iovec iov[OUTPUT_BATCH];
+  struct iovec *curr = iov;
+  size_t i = 0, left = 0;
+  ssize_t written = 0;
+  RETURN_IF_FAIL(out && out->fd >= 0, 0);
+
+  for (i = 0; i < out->count; i++) {
+    iov[i].iov_base = (void *)(uintptr_t)out->batch[i].bytes; // won't write
+    iov[i].iov_len = out->batch[i].size;
+  }
+
+  // usually one call, but writev may write only part of the data
+  left = out->count;
+  while (left > 0) {
+    written = writev(out->fd, curr, (int)left);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    RETURN_IF_FAIL(written >= 0, 0);
+
+    while (left > 0 && (size_t)written >= curr->iov_len) {
+      written -= (ssize_t)curr->iov_len;
+      curr++;
+      left--;
+    }
+    if (left > 0) {
+      curr->iov_base = (uint8_t *)curr->iov_base + written;
+      curr->iov_len -= (size_t)written;
+    }
+  }
+  out->count = 0;
+  return 1;
+}
+
+static int _output_close(struct Output_File *out) {
+  int ok = 0;
+  RETURN_IF_FAIL(out && out->fd >= 0, 0);
+
+  ok = _output_flush(out);
+  if (close(out->fd) != 0) {
+    ok = 0;
+  }
+  out->fd = -1;
+  return ok;
+}
+
+#endif
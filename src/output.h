@@ -4,8 +4,20 @@
 #include "assembler.h"
 #include "common.h"
 
+// Header of .kmx file, all numbers are little endian:
+//   0: 'K' 'M' 'A' <version>
+//   4: uint32 size of code segment
+//   8: uint32 size of data segment in file
+//  12: uint32 size of BSS, zeroes the loader appends after the data segment
+// The code segment follows the header, the data segment follows the code.
+#define KMX_MAGIC "KMA"
+#define KMX_VERSION 2
+#define KMX_HEADER_SIZE 16
+
 // Output correct binary from asp to asp->config->target.
 // Ensure correct KMA header, order of segments in file, etc.
+// The file is written into temporary file next to target first, then renamed,
+// so target is never left half-written.
 enum Err_Main output_binary(const struct Assembler_Processing *asp);
 
 #endif
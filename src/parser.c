@@ -6,7 +6,7 @@
 #include "parser.h"
 #include "parser_grammar.h"
 
-struct Parsed_Statement *parse_tokens(const struct Token *tokens[], size_t nl) {
+struct Parsed_Statement *parse_tokens(const struct Token *tokens, size_t nl) {
   struct Parsed_Statement *stmt = NULL;
   RETURN_IF_FAIL(tokens, NULL);
   stmt = p_stmt_create(STMT_NONE, nl);
@@ -23,6 +23,21 @@ cleanup:
   return NULL;
 }
 
+struct Parsed_Statement *parse_tokens_arena(struct Jarena *arena,
+                                            const struct Token *tokens,
+                                            size_t nl) {
+  struct Parsed_Statement *stmt = NULL;
+  RETURN_IF_FAIL(arena && tokens, NULL);
+  stmt = jarena_alloc(arena, sizeof(struct Parsed_Statement));
+  RETURN_IF_FAIL(stmt, NULL);
+  RETURN_IF_FAIL(p_stmt_init(stmt, STMT_NONE, nl), NULL);
+  stmt->arena = arena;
+
+  RETURN_IF_FAIL(grammar_line(stmt, tokens) == GRM_MATCH, NULL);
+
+  return stmt;
+}
+
 struct Parsed_Statement *p_stmt_create(enum Statement_Type stype, size_t nl) {
   struct Parsed_Statement *ps = jalloc(sizeof(struct Parsed_Statement));
   CLEANUP_IF_FAIL(ps);
@@ -45,6 +60,7 @@ int p_stmt_init(struct Parsed_Statement *ps, enum Statement_Type type,
   ps->type = type;
   ps->err = PAR_NO_ERROR;
   ps->line_number = nl;
+  ps->arena = NULL;
 
   switch (ps->type) {
   case STMT_NONE:
@@ -53,7 +69,7 @@ int p_stmt_init(struct Parsed_Statement *ps, enum Statement_Type type,
   case STMT_SECTION_CODE:
     break;
   case STMT_LABEL_DEF:
-    *ps->content.label_def.label_name = 0;
+    ps->content.label_def.label_id = 0;
     break;
   case STMT_DATA_DECL:
     memset(&ps->content.data_decl, 0, sizeof(ps->content.data_decl));
@@ -85,10 +101,10 @@ void p_stmt_deinit(struct Parsed_Statement *ps) {
   case STMT_SECTION_CODE:
     break;
   case STMT_LABEL_DEF:
-    *ps->content.label_def.label_name = 0;
+    ps->content.label_def.label_id = 0;
     break;
   case STMT_DATA_DECL:
-    if (ps->content.data_decl.segments) {
+    if (ps->content.data_decl.segments && !ps->arena) {
       jree(ps->content.data_decl.segments);
     }
     memset(&ps->content.data_decl, 0, sizeof(ps->content.data_decl));
@@ -113,7 +129,9 @@ void p_stmt_free(struct Parsed_Statement **stmt) {
   CLEANUP_IF_FAIL(stmt && *stmt);
 
   p_stmt_deinit(*stmt);
-  jree(*stmt);
+  if (!(*stmt)->arena) { // arena releases its memory on reset
+    jree(*stmt);
+  }
   *stmt = NULL;
 
 cleanup:
@@ -34,20 +34,29 @@ struct Parsed_Statement {
     struct Data_Declaration data_decl;
     struct Label_Definition label_def;
   } content;
+  struct Jarena *arena; // statement & its segments come from, NULL if heap
 };
 
-// Create new Parsed Statement from array of Tokens. This array MUST be ended by
-// the EOF Token. If the operation fails, NULL is returned. If the Parsed
-// Statement is returned with err different that PAR_NO_ERROR, than read the
-// error.
-struct Parsed_Statement *parse_tokens(const struct Token *tokens[], size_t nl);
+// Create new Parsed Statement from contiguous array of Tokens, as the lexer
+// produces it. This array MUST be ended by the EOF Token. Names of labels and
+// identifiers MUST be interned (lexed with a symtab, see lexer_tokenize_span),
+// lines with names of TOKEN_NO_ID fail to parse. If the operation fails, NULL
+// is returned. If the Parsed Statement is returned with err different that
+// PAR_NO_ERROR, than read the error.
+struct Parsed_Statement *parse_tokens(const struct Token *tokens, size_t nl);
+
+// Same as parse_tokens, but the statement with all its insides is allocated
+// from arena, it is released by resetting the arena. Return NULL on failure.
+struct Parsed_Statement *parse_tokens_arena(struct Jarena *arena,
+                                            const struct Token *tokens,
+                                            size_t nl);
 
 // Create new Parsed Statement and initializes the content by calling
 // p_stmt_init. Return pointer or NULL.
 struct Parsed_Statement *p_stmt_create(enum Statement_Type stype, size_t nl);
 
-// Initialize the Parsed Statements insides based on type,
-// return 1 on success, 0 on failure.
+// Initialize the Parsed Statements insides based on type, its insides will be
+// allocated by jalloc. Return 1 on success, 0 on failure.
 int p_stmt_init(struct Parsed_Statement *ps, enum Statement_Type type,
                 size_t nl);
 
@@ -55,7 +64,7 @@ int p_stmt_init(struct Parsed_Statement *ps, enum Statement_Type type,
 void p_stmt_deinit(struct Parsed_Statement *ps);
 
 // Free any Parsed Statement dynamically allocated.
-// Calls p_stmt_deinit before freeing.
+// Calls p_stmt_deinit before freeing, statement from arena is only deinited.
 // Set *stmt = NULL on success
 void p_stmt_free(struct Parsed_Statement **stmt);
 
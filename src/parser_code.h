@@ -1,10 +1,10 @@
 #ifndef PARSER_CODE_H
 #define PARSER_CODE_H
 
-#include "instruction.h"
+#include <stddef.h>
+#include <stdint.h>
 
-#define MAX_REGISTER_NAME_LEN 4
-#define MAX_LABEL_NAME_LEN 256
+#include "instruction.h"
 
 // instruction table doesn't know offset & label, but in kma-assembly it
 // sometimes is. this is a way to count for it
@@ -14,25 +14,27 @@ enum Operand_Specifier {
   OPS_LABEL,    // type is imm32, but really is a label
 };
 
-// in an instruction
+// in an instruction, 8 bytes
 struct Operand {
-  enum Operand_Type type;
-  enum Operand_Specifier specifier;
+  uint8_t type;      // enum Operand_Type
+  uint8_t specifier; // enum Operand_Specifier
   union {
-    char register_name[MAX_REGISTER_NAME_LEN]; // A, B, C,...
+    uint8_t reg; // enum Register_Code of A, B, C,...
     int32_t immediate_value;
-    char label[MAX_LABEL_NAME_LEN]; // Name of label/variable being referenced
+    uint32_t symbol_id; // label/variable being referenced, see symtab_get
   } value;
 };
 
+// Compact enough to keep whole programs in memory, referenced symbols are
+// kept by the ids the lexer interned their names to.
 struct Instruction_Statement {
-  int operand_count;
-  struct Operand operands[2];
   const struct Instruction_Descriptor *descriptor; // equivalent descriptor
+  struct Operand operands[2];
+  uint8_t operand_count;
 };
 
 struct Label_Definition {
-  char label_name[MAX_LABEL_NAME_LEN]; // The label name including @
+  uint32_t label_id; // symbol id of the label name including @
 };
 
 #endif
@@ -4,8 +4,9 @@
 #include <stddef.h>
 #include <stdint.h>
 
-#define MAX_IDENTIFIER_LEN 256
-#define MAX_INIT_SEGMENT_STRING_LEN 256
+// Segments of one declaration grow geometrically, long lists stay linear.
+#define DATA_DECL_SEGMENTS_INITIAL_CAPACITY 4
+#define DATA_DECL_SEGMENTS_CAPACITY_MULT 2
 
 enum Data_Type { DATA_DWORD, DATA_BYTE, DATA_ERROR };
 
@@ -25,7 +26,10 @@ struct Init_Segment {
       size_t count;                           // how many
       int32_t value;                          // number - or ? if is_uninit
     } dup;                                    // dup
-    char string[MAX_INIT_SEGMENT_STRING_LEN]; // string
+    struct {
+      const char *text; // view into the source line, NOT NULL-terminated
+      size_t len;       // number of characters, not limited
+    } string;           // string
   } data;
   size_t element_count; // length of string/count in dup/1 for number
   int is_uninit;        // is value/dup un-initialized
@@ -33,13 +37,15 @@ struct Init_Segment {
 
 // when delaring an assembler variable
 struct Data_Declaration {
-  char identifier[MAX_IDENTIFIER_LEN]; // name of variable
+  uint32_t identifier_id; // symbol id of the name of variable
   enum Data_Type type;
 
   struct Init_Segment *segments; // array of segments
   size_t segment_count;
+  size_t segment_capacity; // allocated segments, at least segment_count
 
   size_t total_size;   // total size of all segments->element_count
+  size_t literal_size; // part of total_size in VALUE and STRING segments
   int is_fully_uninit; // if 1 if and only if every init segment is_uninit
 };
 
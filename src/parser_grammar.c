@@ -1,5 +1,3 @@
-#include <errno.h>
-#include <inttypes.h>
 #include <limits.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -17,9 +15,9 @@
 
 // ===== TOKEN HELPER MACROS =====
 #define NOMATCH_IF_FAIL(cond) RETURN_IF_FAIL((cond), GRM_NO_MATCH)
-#define TOK_ARR(...) ((const enum Token_Type[]){__VA_ARGS__})
-#define TOK_CURR tokens[0]
-#define TOK_NEXT tokens[1]
+#define TOK_CURR (&tokens[0])
+#define TOK_NEXT (&tokens[1])
+#define DUP_TOKEN_COUNT 5 // NUMBER, DUP, LPAREN, NUMBER/QUESTION, RPAREN
 
 // ===== TOKEN HELPER DECLARATIONS =====
 
@@ -29,17 +27,15 @@ static int _token_is(const struct Token *token, enum Token_Type type);
 // Check if token is not null and its type is EOF.
 static int _token_is_eof(const struct Token *token);
 
-// Check if first n tokens exist are exact types.
-static int _tokens_start_with(const struct Token *tokens[], size_t n,
-                              const enum Token_Type types[]);
+// Check if token is of <type> and the one after it is EOF. Never reads past
+// the EOF, as the second token is checked only if the first one matched.
+static int _token_is_last(const struct Token *tokens, enum Token_Type type);
 
-// ===== STRING HELPER DECLARATIONS =====
+// ===== SYMBOL HELPER DECLARATIONS =====
 
-// copy token->value into dest and NULL-terminates
-static int _copy_token_value(const struct Token *token, char *dest, size_t len);
-
-// Safe wrapper of strcmp(token->value, s)
-static int _token_value_eq(const struct Token *token, const char *s);
+// Set *out to the symbol id the lexer interned token name to.
+// Fail if the name is empty or wasn't interned.
+static int _token_symbol_id(const struct Token *token, uint32_t *out);
 
 // ===== NUMBER HELPER DECLARATIONS =====
 
@@ -49,37 +45,91 @@ static int _parse_size_t(const struct Token *token, size_t *out);
 
 // ===== SEGMENT HELPER DECLARATIONS =====
 
-// Increment pstmt segment count.
+// Make room for at least n segments, growing the array geometrically (from
+// the arena of pstmt, if it has one). Return 1 on success, 0 on failure.
+static int _reserve_segments(struct Parsed_Statement *pstmt, size_t n);
+
+// Increment pstmt segment count, growing the segments if needed.
 // Return idx of appended segment on success, SIZE_MAX on failure.
 static size_t _append_segment(struct Parsed_Statement *pstmt);
 
-// Allocate space for segments
+// Make sure every counted segment is allocated and set is_fully_uninit.
 static int _finalize_segments(struct Parsed_Statement *pstmt);
 
-// Set total size of data declaration based on defined segments
-// Return 1 on success, 0 on failure.
+// Set total size of data declaration based on defined segments. Sizes which
+// overflow are saturated at SIZE_MAX, so the assembler reports them as too
+// large. Return 1 on success, 0 on failure.
 static int _set_total_size(struct Data_Declaration *dd);
 
+// Return a + b, or SIZE_MAX if it overflows.
+static size_t _size_add_sat(size_t a, size_t b);
+
 // Decrement pstmt segment count on failure
 static void _remove_last_segment(struct Parsed_Statement *pstmt);
 
 // ===== GRAMMAR HELPER DECLARATIONS =====
 
 // Both grammar_identifier_DW/DB_dec do almost the same = centralized control &
-// maintenance. If !is_dw then is_db.
+// maintenance. If !is_dw then is_db. Walks the comma separated list in a loop
+// till the EOF, so even very long lists use constant stack.
 static enum Err_Grm _grammar_identifier_dec(struct Parsed_Statement *pstmt,
-                                            const struct Token *tokens[],
+                                            const struct Token *tokens,
                                             int is_dw);
 
 // Very similiar functionality of DW/DB. Centralized logic, switchable.
 static enum Err_Grm _grammar_identifier_dec2(struct Parsed_Statement *pstmt,
-                                             const struct Token *tokens[],
+                                             const struct Token *tokens,
                                              int is_dw);
 
-// Common logic for both DW/DB_dup.
+// Match one element of the list into a newly appended segment and set *used
+// to how many tokens it took.
+static enum Err_Grm _grammar_identifier_elem(struct Parsed_Statement *pstmt,
+                                             const struct Token *tokens,
+                                             int is_dw, size_t *used);
+
+// Common logic for both DW/DB_dup. Match the DUP_TOKEN_COUNT tokens and fill
+// the segment on segment_idx, which must be already allocated.
 static enum Err_Grm _grammar_identifier_dup(struct Parsed_Statement *pstmt,
-                                            const struct Token *tokens[],
-                                            size_t segment_idx, int is_dw);
+                                            const struct Token *tokens,
+                                            size_t segment_idx);
+
+// Match the empty line, which is just the EOF.
+static enum Err_Grm _grammar_line_empty(struct Parsed_Statement *pstmt,
+                                        const struct Token *tokens);
+
+// States of the operand automaton, it folds <instruction_rhs> and
+// <instruction_rhs_after> into one forward pass over the tokens.
+enum Operand_State {
+  OPST_FIRST,     // first operand or EOF
+  OPST_FIRST_REG, // register was first, COMMA or EOF
+  OPST_SECOND,    // after COMMA, second operand
+  OPST_OFFSET,    // after OFFSET, its identifier
+  OPST_LAST,      // every operand is read, EOF
+  OPST_ACCEPT,    // EOF was consumed
+};
+
+// Run the operand automaton from state <start> until the EOF. Fill operands of
+// pstmt on the way. Return GRM_MATCH when the EOF is accepted, GRM_NO_MATCH on
+// unexpected token, GRM_GENERIC_ERROR when operand can't be stored.
+static enum Err_Grm _grammar_operands(struct Parsed_Statement *pstmt,
+                                      const struct Token *tokens,
+                                      enum Operand_State start);
+
+// ===== DISPATCH TABLE =====
+
+// The grammar is LL(1) on lines: the first token alone decides which <line>
+// production applies, so grammar_line indexes this table by its type. Tokens
+// no line can start with have NULL.
+static enum Err_Grm (*const LINE_TABLE[TOKEN_TYPE_COUNT])(
+    struct Parsed_Statement *, const struct Token *) = {
+    [TOKEN_KMA] = grammar_line_kma,
+    [TOKEN_SECTION_CODE] = grammar_line_code,
+    [TOKEN_SECTION_DATA] = grammar_line_data,
+    [TOKEN_LABEL] = grammar_line_label,
+    [TOKEN_IDENTIFIER] = grammar_line_identifier,
+    [TOKEN_INSTRUCTION] = grammar_line_instruction,
+    [TOKEN_EOF] = _grammar_line_empty,
+};
 
 // ===== INIT HELPER DECLARATIONS =====
 
@@ -101,62 +151,42 @@ static int _set_segment_string(struct Parsed_Statement *pstmt,
 // set both operands
 static int _set_ops_none(struct Instruction_Statement *is);
 
-// set is->op[idx] to label of token->value
-static int _set_op_label(struct Instruction_Statement *is,
-                         const struct Token *token, size_t idx);
+// set is->op[idx] to symbol of given specifier (label or offset), referenced
+// by the id the lexer interned its name to
+static int _set_op_symbol(struct Instruction_Statement *is,
+                          const struct Token *token, size_t idx,
+                          enum Operand_Specifier specifier);
 
-// set is->op[idx] to register of token->value
+// set is->op[idx] to register code already computed by lexer
 static int _set_op_register(struct Instruction_Statement *is,
                             const struct Token *token, size_t idx);
 
-// set is->op[idx] to number saved in string format in token->value
+// set is->op[idx] to number already computed by lexer
 static int _set_op_number(struct Instruction_Statement *is,
                           const struct Token *token, size_t idx);
 
-// set is->op[idx] to offset, token must point to identifier
-static int _set_op_offset(struct Instruction_Statement *is,
-                          const struct Token *token, size_t idx);
-
 // set is->op_count to idx+1 if possible.
 static int _set_op_count(struct Instruction_Statement *is, size_t idx);
 
 // ===== HEADER DEFINITIONS =====
 
 enum Err_Grm grammar_line(struct Parsed_Statement *pstmt,
-                          const struct Token *tokens[]) {
-  NOMATCH_IF_FAIL(pstmt && tokens && *tokens);
+                          const struct Token *tokens) {
+  enum Err_Grm (*production)(struct Parsed_Statement *,
+                             const struct Token *) = NULL;
+  NOMATCH_IF_FAIL(pstmt && tokens);
+  NOMATCH_IF_FAIL((size_t)TOK_CURR->type < TOKEN_TYPE_COUNT);
 
-  if (grammar_line_kma(pstmt, tokens) == GRM_MATCH) {
-    return GRM_MATCH;
-  }
-  if (grammar_line_code(pstmt, tokens) == GRM_MATCH) {
-    return GRM_MATCH;
-  }
-  if (grammar_line_data(pstmt, tokens) == GRM_MATCH) {
-    return GRM_MATCH;
-  }
-  if (grammar_line_label(pstmt, tokens) == GRM_MATCH) {
-    return GRM_MATCH;
-  }
-  if (grammar_line_identifier(pstmt, tokens) == GRM_MATCH) {
-    return GRM_MATCH;
-  }
-  if (grammar_line_instruction(pstmt, tokens) == GRM_MATCH) {
-    return GRM_MATCH;
-  }
-  if (_token_is_eof(TOK_CURR)) {
-    pstmt->type = STMT_NONE;
-    pstmt->err = PAR_EMPTY_LINE;
-    return GRM_MATCH;
-  }
+  production = LINE_TABLE[TOK_CURR->type];
+  NOMATCH_IF_FAIL(production);
 
-  return GRM_NO_MATCH;
+  return production(pstmt, tokens);
 }
 
 enum Err_Grm grammar_line_kma(struct Parsed_Statement *pstmt,
-                              const struct Token *tokens[]) {
-  NOMATCH_IF_FAIL(pstmt && tokens && *tokens);
-  NOMATCH_IF_FAIL(_tokens_start_with(tokens, 2, TOK_ARR(TOKEN_KMA, TOKEN_EOF)));
+                              const struct Token *tokens) {
+  NOMATCH_IF_FAIL(pstmt && tokens);
+  NOMATCH_IF_FAIL(_token_is_last(tokens, TOKEN_KMA));
 
   pstmt->type = STMT_KMA;
   pstmt->err = PAR_NO_ERROR;
@@ -165,10 +195,9 @@ enum Err_Grm grammar_line_kma(struct Parsed_Statement *pstmt,
 }
 
 enum Err_Grm grammar_line_code(struct Parsed_Statement *pstmt,
-                               const struct Token *tokens[]) {
-  NOMATCH_IF_FAIL(pstmt && tokens && *tokens);
-  NOMATCH_IF_FAIL(
-      _tokens_start_with(tokens, 2, TOK_ARR(TOKEN_SECTION_CODE, TOKEN_EOF)));
+                               const struct Token *tokens) {
+  NOMATCH_IF_FAIL(pstmt && tokens);
+  NOMATCH_IF_FAIL(_token_is_last(tokens, TOKEN_SECTION_CODE));
 
   pstmt->type = STMT_SECTION_CODE;
   pstmt->err = PAR_NO_ERROR;
@@ -177,10 +206,9 @@ enum Err_Grm grammar_line_code(struct Parsed_Statement *pstmt,
 }
 
 enum Err_Grm grammar_line_data(struct Parsed_Statement *pstmt,
-                               const struct Token *tokens[]) {
-  NOMATCH_IF_FAIL(pstmt && tokens && *tokens);
-  NOMATCH_IF_FAIL(
-      _tokens_start_with(tokens, 2, TOK_ARR(TOKEN_SECTION_DATA, TOKEN_EOF)));
+                               const struct Token *tokens) {
+  NOMATCH_IF_FAIL(pstmt && tokens);
+  NOMATCH_IF_FAIL(_token_is_last(tokens, TOKEN_SECTION_DATA));
 
   pstmt->type = STMT_SECTION_DATA;
   pstmt->err = PAR_NO_ERROR;
@@ -189,71 +217,68 @@ enum Err_Grm grammar_line_data(struct Parsed_Statement *pstmt,
 }
 
 enum Err_Grm grammar_line_label(struct Parsed_Statement *pstmt,
-                                const struct Token *tokens[]) {
-  NOMATCH_IF_FAIL(pstmt && tokens && *tokens);
-  NOMATCH_IF_FAIL(
-      _tokens_start_with(tokens, 2, TOK_ARR(TOKEN_LABEL, TOKEN_EOF)));
+                                const struct Token *tokens) {
+  uint32_t id = 0;
+  NOMATCH_IF_FAIL(pstmt && tokens);
+  NOMATCH_IF_FAIL(_token_is_last(tokens, TOKEN_LABEL));
+  RETURN_IF_FAIL(_token_symbol_id(TOK_CURR, &id), GRM_GENERIC_ERROR);
 
   pstmt->type = STMT_LABEL_DEF;
   pstmt->err = PAR_NO_ERROR;
-
-  RETURN_IF_FAIL(_copy_token_value(TOK_CURR,
-                                   pstmt->content.label_def.label_name,
-                                   sizeof(pstmt->content.label_def.label_name)),
-                 GRM_GENERIC_ERROR);
+  pstmt->content.label_def.label_id = id;
 
   return GRM_MATCH;
 }
 
 enum Err_Grm grammar_line_identifier(struct Parsed_Statement *pstmt,
-                                     const struct Token *tokens[]) {
-  NOMATCH_IF_FAIL(pstmt && tokens && *tokens);
+                                     const struct Token *tokens) {
+  uint32_t id = 0;
+  NOMATCH_IF_FAIL(pstmt && tokens);
   NOMATCH_IF_FAIL(_token_is(TOK_CURR, TOKEN_IDENTIFIER));
-  NOMATCH_IF_FAIL(grammar_identifier_def(pstmt, &TOK_NEXT) == GRM_MATCH);
+  RETURN_IF_FAIL(_token_symbol_id(TOK_CURR, &id), GRM_GENERIC_ERROR);
+  NOMATCH_IF_FAIL(grammar_identifier_def(pstmt, TOK_NEXT) == GRM_MATCH);
 
   pstmt->type = STMT_DATA_DECL;
   pstmt->err = PAR_NO_ERROR;
+  pstmt->content.data_decl.identifier_id = id;
 
   RETURN_IF_FAIL(_set_total_size(&pstmt->content.data_decl), GRM_GENERIC_ERROR);
-  RETURN_IF_FAIL(_copy_token_value(TOK_CURR,
-                                   pstmt->content.data_decl.identifier,
-                                   sizeof(pstmt->content.data_decl.identifier)),
-                 GRM_GENERIC_ERROR);
 
   return GRM_MATCH;
 }
 
 enum Err_Grm grammar_line_instruction(struct Parsed_Statement *pstmt,
-                                      const struct Token *tokens[]) {
+                                      const struct Token *tokens) {
   struct Instruction_Statement *is = NULL;
-  NOMATCH_IF_FAIL(pstmt && tokens && *tokens);
+  NOMATCH_IF_FAIL(pstmt && tokens);
 
   NOMATCH_IF_FAIL(_token_is(TOK_CURR, TOKEN_INSTRUCTION));
 
-  NOMATCH_IF_FAIL(grammar_instruction_rhs(pstmt, &TOK_NEXT) == GRM_MATCH);
+  NOMATCH_IF_FAIL(grammar_instruction_rhs(pstmt, TOK_NEXT) == GRM_MATCH);
 
   pstmt->type = STMT_INSTRUCTION;
   pstmt->err = PAR_NO_ERROR;
   is = &pstmt->content.instruction;
-  is->descriptor = instruction_find(TOK_CURR->value, strlen(TOK_CURR->value),
-                                    is->operands[0].type, is->operands[1].type);
+  is->descriptor =
+      instruction_find_id((enum Mnemonic)TOK_CURR->id,
+                          (enum Operand_Type)is->operands[0].type,
+                          (enum Operand_Type)is->operands[1].type);
   RETURN_IF_FAIL(is->descriptor, GRM_GENERIC_ERROR);
 
   return GRM_MATCH;
 }
 
 enum Err_Grm grammar_identifier_def(struct Parsed_Statement *pstmt,
-                                    const struct Token *tokens[]) {
-  NOMATCH_IF_FAIL(pstmt && tokens && *tokens);
+                                    const struct Token *tokens) {
+  NOMATCH_IF_FAIL(pstmt && tokens);
 
   NOMATCH_IF_FAIL(_token_is(TOK_CURR, TOKEN_DATA_TYPE));
 
-  if (_token_value_eq(TOK_CURR, "DWORD") || _token_value_eq(TOK_CURR, "DW")) {
-    CLEANUP_IF_FAIL(grammar_identifier_dw_dec(pstmt, &TOK_NEXT) == GRM_MATCH);
+  if (TOK_CURR->id == KW_DWORD) {
+    CLEANUP_IF_FAIL(grammar_identifier_dw_dec(pstmt, TOK_NEXT) == GRM_MATCH);
     pstmt->content.data_decl.type = DATA_DWORD;
-  } else if (_token_value_eq(TOK_CURR, "BYTE") ||
-             _token_value_eq(TOK_CURR, "DB")) {
-    CLEANUP_IF_FAIL(grammar_identifier_db_dec(pstmt, &TOK_NEXT) == GRM_MATCH);
+  } else if (TOK_CURR->id == KW_BYTE) {
+    CLEANUP_IF_FAIL(grammar_identifier_db_dec(pstmt, TOK_NEXT) == GRM_MATCH);
     pstmt->content.data_decl.type = DATA_BYTE;
   } else {
     return GRM_NO_MATCH;
@@ -265,109 +290,73 @@ enum Err_Grm grammar_identifier_def(struct Parsed_Statement *pstmt,
   return GRM_MATCH;
 
 cleanup:
-  if (pstmt->content.data_decl.segments) {
+  if (pstmt->content.data_decl.segments && !pstmt->arena) {
     jree(pstmt->content.data_decl.segments);
   }
+  pstmt->content.data_decl.segments = NULL;
+  pstmt->content.data_decl.segment_count = 0;
+  pstmt->content.data_decl.segment_capacity = 0;
   return GRM_NO_MATCH;
 }
 
 enum Err_Grm grammar_identifier_dw_dec(struct Parsed_Statement *pstmt,
-                                       const struct Token *tokens[]) {
+                                       const struct Token *tokens) {
   return _grammar_identifier_dec(pstmt, tokens, 1);
 }
 
 enum Err_Grm grammar_identifier_dw_dec2(struct Parsed_Statement *pstmt,
-                                        const struct Token *tokens[]) {
+                                        const struct Token *tokens) {
   return _grammar_identifier_dec2(pstmt, tokens, 1);
 }
 
 enum Err_Grm grammar_identifier_dw_dup(struct Parsed_Statement *pstmt,
-                                       const struct Token *tokens[],
+                                       const struct Token *tokens,
                                        size_t segment_idx) {
-  enum Err_Grm res = _grammar_identifier_dup(pstmt, tokens, segment_idx, 1);
+  enum Err_Grm res = GRM_NO_MATCH;
+  NOMATCH_IF_FAIL(pstmt && tokens && segment_idx < SIZE_MAX);
+  RETURN_IF_FAIL(_reserve_segments(pstmt, segment_idx + 1), GRM_GENERIC_ERROR);
+
+  res = _grammar_identifier_dup(pstmt, tokens, segment_idx);
   if (res != GRM_MATCH) {
     return res;
   }
-  if (!_set_segment_dup(pstmt, segment_idx)) {
-    return GRM_GENERIC_ERROR;
-  }
-  return GRM_MATCH;
+  return _grammar_identifier_dec2(pstmt, &tokens[DUP_TOKEN_COUNT], 1);
 }
 
 enum Err_Grm grammar_identifier_db_dec(struct Parsed_Statement *pstmt,
-                                       const struct Token *tokens[]) {
+                                       const struct Token *tokens) {
   return _grammar_identifier_dec(pstmt, tokens, 0);
 }
 
 enum Err_Grm grammar_identifier_db_dec2(struct Parsed_Statement *pstmt,
-                                        const struct Token *tokens[]) {
+                                        const struct Token *tokens) {
   return _grammar_identifier_dec2(pstmt, tokens, 0);
 }
 
 enum Err_Grm grammar_identifier_db_dup(struct Parsed_Statement *pstmt,
-                                       const struct Token *tokens[],
+                                       const struct Token *tokens,
                                        size_t segment_idx) {
-  enum Err_Grm res = _grammar_identifier_dup(pstmt, tokens, segment_idx, 0);
+  enum Err_Grm res = GRM_NO_MATCH;
+  NOMATCH_IF_FAIL(pstmt && tokens && segment_idx < SIZE_MAX);
+  RETURN_IF_FAIL(_reserve_segments(pstmt, segment_idx + 1), GRM_GENERIC_ERROR);
+
+  res = _grammar_identifier_dup(pstmt, tokens, segment_idx);
   if (res != GRM_MATCH) {
     return res;
   }
-  if (!_set_segment_dup(pstmt, segment_idx)) {
-    return GRM_GENERIC_ERROR;
-  }
-  return GRM_MATCH;
+  return _grammar_identifier_dec2(pstmt, &tokens[DUP_TOKEN_COUNT], 0);
 }
 
 enum Err_Grm grammar_instruction_rhs(struct Parsed_Statement *pstmt,
-                                     const struct Token *tokens[]) {
-  struct Instruction_Statement *is = NULL;
-  NOMATCH_IF_FAIL(pstmt && tokens && *tokens);
-  is = &pstmt->content.instruction;
-
-  if (_token_is_eof(TOK_CURR)) {
-    RETURN_IF_FAIL(_set_ops_none(is), GRM_GENERIC_ERROR);
-    return GRM_MATCH;
-  } else if (_tokens_start_with(tokens, 2, TOK_ARR(TOKEN_LABEL, TOKEN_EOF))) {
-    RETURN_IF_FAIL(_set_op_label(is, TOK_CURR, 0), GRM_GENERIC_ERROR);
-    return GRM_MATCH;
-  } else if (_tokens_start_with(tokens, 2,
-                                TOK_ARR(TOKEN_REGISTER, TOKEN_EOF))) {
-    RETURN_IF_FAIL(_set_op_register(is, TOK_CURR, 0), GRM_GENERIC_ERROR);
-    return GRM_MATCH;
-  } else if (_tokens_start_with(tokens, 2, TOK_ARR(TOKEN_NUMBER, TOKEN_EOF))) {
-    RETURN_IF_FAIL(_set_op_number(is, TOK_CURR, 0), GRM_GENERIC_ERROR);
-    return GRM_MATCH;
-  } else if (_tokens_start_with(tokens, 2,
-                                TOK_ARR(TOKEN_REGISTER, TOKEN_COMMA))) {
-    NOMATCH_IF_FAIL(grammar_instruction_rhs_after(pstmt, &tokens[2]) ==
-                    GRM_MATCH);
-    RETURN_IF_FAIL(_set_op_register(is, TOK_CURR, 0), GRM_GENERIC_ERROR);
-    return GRM_MATCH;
-  }
-
-  return GRM_NO_MATCH;
+                                     const struct Token *tokens) {
+  NOMATCH_IF_FAIL(pstmt && tokens);
+  return _grammar_operands(pstmt, tokens, OPST_FIRST);
 }
 
 enum Err_Grm grammar_instruction_rhs_after(struct Parsed_Statement *pstmt,
-                                           const struct Token *tokens[]) {
-  NOMATCH_IF_FAIL(pstmt && tokens && *tokens);
-
-  if (_tokens_start_with(tokens, 2, TOK_ARR(TOKEN_REGISTER, TOKEN_EOF))) {
-    RETURN_IF_FAIL(_set_op_register(&pstmt->content.instruction, TOK_CURR, 1),
-                   GRM_GENERIC_ERROR);
-    return GRM_MATCH;
-  } else if (_tokens_start_with(tokens, 2, TOK_ARR(TOKEN_NUMBER, TOKEN_EOF))) {
-    RETURN_IF_FAIL(_set_op_number(&pstmt->content.instruction, TOK_CURR, 1),
-                   GRM_GENERIC_ERROR);
-    return GRM_MATCH;
-  } else if (_tokens_start_with(
-                 tokens, 3,
-                 TOK_ARR(TOKEN_OFFSET, TOKEN_IDENTIFIER, TOKEN_EOF))) {
-    RETURN_IF_FAIL(_set_op_offset(&pstmt->content.instruction, tokens[1], 1),
-                   GRM_GENERIC_ERROR);
-    return GRM_MATCH;
-  }
-
-  return GRM_NO_MATCH;
+                                           const struct Token *tokens) {
+  NOMATCH_IF_FAIL(pstmt && tokens);
+  return _grammar_operands(pstmt, tokens, OPST_SECOND);
 }
 
 // ===== TOKEN HELPER DEFINITIONS =====
@@ -380,126 +369,143 @@ static int _token_is_eof(const struct Token *tok) {
   return (tok && tok->type == TOKEN_EOF);
 }
 
-static int _tokens_start_with(const struct Token *tokens[], size_t n,
-                              const enum Token_Type types[]) {
-  size_t i = 0;
-  if (!tokens || !*tokens || !types) {
-    return 0;
-  }
-
-  for (i = 0; i < n; i++) {
-    if (!_token_is(tokens[i], types[i])) {
-      return 0;
-    }
-    if (i < n - 1 && _token_is_eof(tokens[i])) {
-      return 0; // don't go past the end of array
-    }
-  }
-
-  return 1;
+static int _token_is_last(const struct Token *tokens, enum Token_Type type) {
+  return (_token_is(TOK_CURR, type) && type != TOKEN_EOF &&
+          _token_is_eof(TOK_NEXT));
 }
 
-// ===== STRING HELPER DEFINITIONS =====
+// ===== SYMBOL HELPER DEFINITIONS =====
 
-static int _copy_token_value(const struct Token *token, char *dest,
-                             size_t len) {
-  size_t copy_len = len - 1;
-  RETURN_IF_FAIL(token && dest && copy_len > 0, 0);
-
-  memcpy(dest, token->value, copy_len);
-  dest[copy_len] = '\0';
+static int _token_symbol_id(const struct Token *token, uint32_t *out) {
+  RETURN_IF_FAIL(token && out, 0);
+  RETURN_IF_FAIL(token->len > 0, 0);
+  RETURN_IF_FAIL(token->id >= 0, 0);
 
+  *out = (uint32_t)token->id;
   return 1;
 }
 
-static int _token_value_eq(const struct Token *token, const char *s) {
-  RETURN_IF_FAIL(token && s, 0);
-
-  return (strcmp(token->value, s) == 0);
-}
-
 // ===== NUMBER HELPER DEFINITIONS =====
 
 static int _parse_int32(const struct Token *token, int32_t *out) {
-  intmax_t res = 0;
-  char *end = NULL;
-  RETURN_IF_FAIL(token && out, 0);
+  RETURN_IF_FAIL(token && out && token->type == TOKEN_NUMBER, 0);
 
-  errno = 0;
-  res = strtoimax(token->value, &end, 10);
-  if (end == token->value)
-    return 0; // no digits parsed
-  if (errno == ERANGE)
+  if (token->number < INT32_MIN || token->number > INT32_MAX)
     return 0; // out of range
-  if (res < INT32_MIN || res > INT32_MAX)
-    return 0;
 
-  *out = (int32_t)res;
+  *out = (int32_t)token->number;
   return 1;
 }
 
 static int _parse_size_t(const struct Token *token, size_t *out) {
-  unsigned long long res = 0;
-  char *end = NULL;
-  RETURN_IF_FAIL(token && out, 0);
+  RETURN_IF_FAIL(token && out && token->type == TOKEN_NUMBER, 0);
 
-  errno = 0;
-  res =
-      strtoull(token->value, &end, 10); // unsigned long long is bigger > size_t
-  if (end == token->value)
-    return 0; // no digits
-  if (errno == ERANGE)
-    return 0; // overflow
-  if (res > SIZE_MAX)
+  if (token->number < 0)
+    return 0; // count can't be negative
+  if ((uint64_t)token->number > SIZE_MAX)
     return 0; // bigger > size_t
 
-  *out = (size_t)res;
+  *out = (size_t)token->number;
   return 1;
 }
 
 // ===== SEGMENT HELPER DEFINITIONS =====
 
+static int _reserve_segments(struct Parsed_Statement *pstmt, size_t n) {
+  size_t new_c = 0;
+  struct Data_Declaration *dd = NULL;
+  struct Init_Segment *new_s = NULL;
+  RETURN_IF_FAIL(pstmt, 0);
+  dd = &pstmt->content.data_decl;
+
+  if (dd->segments && n <= dd->segment_capacity) {
+    return 1; // Already have enough space.
+  }
+
+  new_c = dd->segments ? dd->segment_capacity
+                       : DATA_DECL_SEGMENTS_INITIAL_CAPACITY;
+  while (new_c < n) {
+    RETURN_IF_FAIL(new_c <= SIZE_MAX / DATA_DECL_SEGMENTS_CAPACITY_MULT, 0);
+    new_c *= DATA_DECL_SEGMENTS_CAPACITY_MULT;
+  }
+  RETURN_IF_FAIL(new_c <= SIZE_MAX / sizeof(struct Init_Segment), 0);
+
+  if (pstmt->arena) {
+    new_s = jarena_grow(pstmt->arena, dd->segments,
+                        dd->segment_capacity * sizeof(struct Init_Segment),
+                        new_c * sizeof(struct Init_Segment));
+  } else if (dd->segments) {
+    new_s = jealloc(dd->segments, new_c * sizeof(struct Init_Segment));
+  } else {
+    new_s = jalloc(new_c * sizeof(struct Init_Segment));
+  }
+  RETURN_IF_FAIL(new_s, 0);
+
+  dd->segments = new_s;
+  dd->segment_capacity = new_c;
+  return 1;
+}
+
 static size_t _append_segment(struct Parsed_Statement *pstmt) {
+  struct Data_Declaration *dd = NULL;
   RETURN_IF_FAIL(pstmt, SIZE_MAX);
+  dd = &pstmt->content.data_decl;
 
-  if (pstmt->content.data_decl.segment_count == SIZE_MAX) {
+  if (dd->segment_count == SIZE_MAX - 1) {
     return SIZE_MAX;
   }
+  RETURN_IF_FAIL(_reserve_segments(pstmt, dd->segment_count + 1), SIZE_MAX);
 
   // current count = next segment idx (0 vs 1 indexing)
   // return current but increment after
-  return pstmt->content.data_decl.segment_count++;
+  return dd->segment_count++;
 }
 
 static int _finalize_segments(struct Parsed_Statement *pstmt) {
   struct Data_Declaration *dd = NULL;
+  size_t i = 0;
   RETURN_IF_FAIL(pstmt, 0);
 
   dd = &pstmt->content.data_decl;
-  dd->segments = jalloc(dd->segment_count * sizeof(struct Init_Segment));
-  RETURN_IF_FAIL(dd->segments, 0);
+  RETURN_IF_FAIL(_reserve_segments(pstmt, dd->segment_count), 0);
 
-  dd->is_fully_uninit = 1; // set this assumption, if in any segment is not
-                           // true, will be rewritten
+  dd->is_fully_uninit = 1;
+  for (i = 0; i < dd->segment_count; i++) {
+    if (!dd->segments[i].is_uninit) {
+      dd->is_fully_uninit = 0;
+      break;
+    }
+  }
 
   return 1;
 }
 
 static int _set_total_size(struct Data_Declaration *dd) {
-  size_t i = 0, elem_size = 0;
+  size_t i = 0, elem_size = 0, bytes = 0;
   struct Init_Segment *is = NULL;
   RETURN_IF_FAIL(dd && dd->segments, 0);
   elem_size = (dd->type == DATA_DWORD) ? 4 : 1;
   dd->total_size = 0;
+  dd->literal_size = 0;
 
   for (i = 0; i < dd->segment_count; i++) {
     is = &dd->segments[i];
-    dd->total_size += is->element_count * elem_size;
+    bytes = is->element_count > SIZE_MAX / elem_size
+                ? SIZE_MAX
+                : is->element_count * elem_size;
+    dd->total_size = _size_add_sat(dd->total_size, bytes);
+    if (is->type == INIT_SEG_VALUE || is->type == INIT_SEG_STRING) {
+      dd->literal_size = _size_add_sat(dd->literal_size, bytes);
+    }
   }
 
   return 1;
 }
 
+static size_t _size_add_sat(size_t a, size_t b) {
+  return a > SIZE_MAX - b ? SIZE_MAX : a + b;
+}
+
 static void _remove_last_segment(struct Parsed_Statement *pstmt) {
   if (!pstmt) {
     return;
@@ -511,70 +517,43 @@ static void _remove_last_segment(struct Parsed_Statement *pstmt) {
 // ===== GRAMMAR HELPER DECLARATIONS =====
 
 static enum Err_Grm _grammar_identifier_dec(struct Parsed_Statement *pstmt,
-                                            const struct Token *tokens[],
+                                            const struct Token *tokens,
                                             int is_dw) {
-  size_t segment_idx = SIZE_MAX;
-  NOMATCH_IF_FAIL(pstmt && tokens && *tokens);
-
-  segment_idx = _append_segment(pstmt);
-  NOMATCH_IF_FAIL(segment_idx != SIZE_MAX);
-
-  if (_tokens_start_with(tokens, 2, TOK_ARR(TOKEN_NUMBER, TOKEN_DUP))) {
-    if (is_dw) {
-      CLEANUP_IF_FAIL(grammar_identifier_dw_dup(pstmt, &TOK_CURR,
-                                                segment_idx) == GRM_MATCH);
-    } else {
-      CLEANUP_IF_FAIL(grammar_identifier_db_dup(pstmt, &TOK_CURR,
-                                                segment_idx) == GRM_MATCH);
-    }
-    return GRM_MATCH;
-  } else if (_token_is(TOK_CURR, TOKEN_NUMBER)) {
-    if (is_dw) {
-      CLEANUP_IF_FAIL(grammar_identifier_dw_dec2(pstmt, &TOK_NEXT) ==
-                      GRM_MATCH);
-    } else {
-      CLEANUP_IF_FAIL(grammar_identifier_db_dec2(pstmt, &TOK_NEXT) ==
-                      GRM_MATCH);
-    }
-    CLEANUP_IF_FAIL(_set_segment_number(pstmt, segment_idx, TOK_CURR));
-    return GRM_MATCH;
-  } else if (_token_is(TOK_CURR, TOKEN_QUESTION)) {
-    if (is_dw) {
-      CLEANUP_IF_FAIL(grammar_identifier_dw_dec2(pstmt, &TOK_NEXT) ==
-                      GRM_MATCH);
-    } else {
-      CLEANUP_IF_FAIL(grammar_identifier_db_dec2(pstmt, &TOK_NEXT) ==
-                      GRM_MATCH);
+  enum Err_Grm res = GRM_NO_MATCH;
+  size_t first = 0, used = 0;
+  NOMATCH_IF_FAIL(pstmt && tokens);
+  first = pstmt->content.data_decl.segment_count;
+
+  // <identifier_*_dec> and <identifier_*_dec2> alternate till the EOF
+  for (;;) {
+    res = _grammar_identifier_elem(pstmt, tokens, is_dw, &used);
+    if (res != GRM_MATCH) {
+      goto cleanup;
     }
-    CLEANUP_IF_FAIL(_set_segment_uninit(pstmt, segment_idx));
-    return GRM_MATCH;
-  } else {
-    if (!is_dw && _token_is(TOK_CURR, TOKEN_STRING)) {
-      CLEANUP_IF_FAIL(grammar_identifier_db_dec2(pstmt, &TOK_NEXT) ==
-                      GRM_MATCH);
-      CLEANUP_IF_FAIL(_set_segment_string(pstmt, segment_idx, TOK_CURR));
-      return GRM_MATCH;
+    tokens += used;
+    if (!_token_is(TOK_CURR, TOKEN_COMMA)) {
+      break;
     }
+    tokens++;
   }
 
+  res = GRM_NO_MATCH;
+  CLEANUP_IF_FAIL(_token_is_eof(TOK_CURR));
+  CLEANUP_IF_FAIL(_finalize_segments(pstmt));
+  return GRM_MATCH;
+
 cleanup:
-  if (segment_idx < SIZE_MAX) {
-    _remove_last_segment(pstmt);
-  }
-  return GRM_NO_MATCH;
+  pstmt->content.data_decl.segment_count = first;
+  return res;
 }
 
-enum Err_Grm _grammar_identifier_dec2(struct Parsed_Statement *pstmt,
-                                      const struct Token *tokens[], int is_dw) {
-  NOMATCH_IF_FAIL(pstmt && tokens && *tokens);
+static enum Err_Grm _grammar_identifier_dec2(struct Parsed_Statement *pstmt,
+                                             const struct Token *tokens,
+                                             int is_dw) {
+  NOMATCH_IF_FAIL(pstmt && tokens);
 
   if (_token_is(TOK_CURR, TOKEN_COMMA)) {
-    if (is_dw) {
-      NOMATCH_IF_FAIL(grammar_identifier_dw_dec(pstmt, &TOK_NEXT) == GRM_MATCH);
-    } else {
-      NOMATCH_IF_FAIL(grammar_identifier_db_dec(pstmt, &TOK_NEXT) == GRM_MATCH);
-    }
-    return GRM_MATCH;
+    return _grammar_identifier_dec(pstmt, TOK_NEXT, is_dw);
   } else if (_token_is_eof(TOK_CURR)) {
     NOMATCH_IF_FAIL(_finalize_segments(pstmt));
     return GRM_MATCH;
@@ -583,44 +562,145 @@ enum Err_Grm _grammar_identifier_dec2(struct Parsed_Statement *pstmt,
   return GRM_NO_MATCH;
 }
 
-enum Err_Grm _grammar_identifier_dup(struct Parsed_Statement *pstmt,
-                                     const struct Token *tokens[],
-                                     size_t segment_idx, int is_dw) {
-  int is_uninit = 0;
-  size_t dup_len = 5; // how many tokens it takes to have a DUP
-  struct Init_Segment *segment = NULL;
+static enum Err_Grm _grammar_identifier_elem(struct Parsed_Statement *pstmt,
+                                             const struct Token *tokens,
+                                             int is_dw, size_t *used) {
+  size_t segment_idx = SIZE_MAX;
+  enum Err_Grm res = GRM_NO_MATCH;
+  NOMATCH_IF_FAIL(pstmt && tokens && used);
 
-  NOMATCH_IF_FAIL(pstmt && tokens && *tokens);
-  NOMATCH_IF_FAIL(
-      _token_is(tokens[0], TOKEN_NUMBER) && _token_is(tokens[1], TOKEN_DUP) &&
-      _token_is(tokens[2], TOKEN_LPAREN) && _token_is(tokens[4], TOKEN_RPAREN));
-
-  // MATCH VALUE/QUESTION
-  if (_token_is(tokens[3], TOKEN_NUMBER)) {
-    is_uninit = 0;
-  } else if (_token_is(tokens[3], TOKEN_QUESTION)) {
-    is_uninit = 1;
-  } else { // guard so don't descend more if no match
-    return GRM_NO_MATCH;
+  segment_idx = _append_segment(pstmt);
+  RETURN_IF_FAIL(segment_idx != SIZE_MAX, GRM_GENERIC_ERROR);
+  *used = 1;
+
+  if (_token_is(TOK_CURR, TOKEN_NUMBER) && _token_is(TOK_NEXT, TOKEN_DUP)) {
+    res = _grammar_identifier_dup(pstmt, tokens, segment_idx);
+    *used = DUP_TOKEN_COUNT;
+  } else if (_token_is(TOK_CURR, TOKEN_NUMBER)) {
+    res = _set_segment_number(pstmt, segment_idx, TOK_CURR) ? GRM_MATCH
+                                                            : GRM_NO_MATCH;
+  } else if (_token_is(TOK_CURR, TOKEN_QUESTION)) {
+    res = _set_segment_uninit(pstmt, segment_idx) ? GRM_MATCH : GRM_NO_MATCH;
+  } else if (!is_dw && _token_is(TOK_CURR, TOKEN_STRING)) {
+    res = _set_segment_string(pstmt, segment_idx, TOK_CURR) ? GRM_MATCH
+                                                            : GRM_NO_MATCH;
   }
 
-  // TILL the EOF
-  if (is_dw) {
-    NOMATCH_IF_FAIL(grammar_identifier_dw_dec2(pstmt, &tokens[dup_len]) ==
-                    GRM_MATCH);
-  } else {
-    NOMATCH_IF_FAIL(grammar_identifier_db_dec2(pstmt, &tokens[dup_len]) ==
-                    GRM_MATCH);
+  if (res != GRM_MATCH) {
+    _remove_last_segment(pstmt);
   }
+  return res;
+}
+
+static enum Err_Grm _grammar_identifier_dup(struct Parsed_Statement *pstmt,
+                                            const struct Token *tokens,
+                                            size_t segment_idx) {
+  struct Init_Segment *segment = NULL;
+
+  NOMATCH_IF_FAIL(pstmt && tokens);
+  // tokens are contiguous and ended by EOF, so every index is checked only
+  // after all the ones before it matched a non-EOF type
+  NOMATCH_IF_FAIL(_token_is(&tokens[0], TOKEN_NUMBER) &&
+                  _token_is(&tokens[1], TOKEN_DUP) &&
+                  _token_is(&tokens[2], TOKEN_LPAREN));
+  NOMATCH_IF_FAIL(_token_is(&tokens[3], TOKEN_NUMBER) ||
+                  _token_is(&tokens[3], TOKEN_QUESTION));
+  NOMATCH_IF_FAIL(_token_is(&tokens[4], TOKEN_RPAREN));
+
   segment = &pstmt->content.data_decl.segments[segment_idx];
-  segment->is_uninit = is_uninit;
+  segment->is_uninit = _token_is(&tokens[3], TOKEN_QUESTION);
 
   // DUP COUNT
   NOMATCH_IF_FAIL(_parse_size_t(TOK_CURR, &segment->data.dup.count));
 
   // DUP VALUE
-  if (!is_uninit) {
-    NOMATCH_IF_FAIL(_parse_int32(tokens[3], &segment->data.dup.value));
+  segment->data.dup.value = 0;
+  if (!segment->is_uninit) {
+    NOMATCH_IF_FAIL(_parse_int32(&tokens[3], &segment->data.dup.value));
+  }
+
+  NOMATCH_IF_FAIL(_set_segment_dup(pstmt, segment_idx));
+  return GRM_MATCH;
+}
+
+static enum Err_Grm _grammar_line_empty(struct Parsed_Statement *pstmt,
+                                        const struct Token *tokens) {
+  NOMATCH_IF_FAIL(pstmt && tokens);
+  NOMATCH_IF_FAIL(_token_is_eof(TOK_CURR));
+
+  pstmt->type = STMT_NONE;
+  pstmt->err = PAR_EMPTY_LINE;
+
+  return GRM_MATCH;
+}
+
+static enum Err_Grm _grammar_operands(struct Parsed_Statement *pstmt,
+                                      const struct Token *tokens,
+                                      enum Operand_State start) {
+  struct Instruction_Statement *is = &pstmt->content.instruction;
+  enum Operand_State state = start;
+  const struct Token *tok = tokens;
+  int stored = 1;
+
+  while (state != OPST_ACCEPT) {
+    const enum Token_Type type = tok->type;
+
+    switch (state) {
+    case OPST_FIRST:
+      if (type == TOKEN_EOF) {
+        stored = _set_ops_none(is);
+        state = OPST_ACCEPT;
+      } else if (type == TOKEN_REGISTER) {
+        stored = _set_op_register(is, tok, 0);
+        state = OPST_FIRST_REG;
+      } else if (type == TOKEN_LABEL) {
+        stored = _set_op_symbol(is, tok, 0, OPS_LABEL);
+        state = OPST_LAST;
+      } else if (type == TOKEN_NUMBER) {
+        stored = _set_op_number(is, tok, 0);
+        state = OPST_LAST;
+      } else {
+        return GRM_NO_MATCH;
+      }
+      break;
+    case OPST_FIRST_REG:
+      if (type == TOKEN_COMMA) {
+        state = OPST_SECOND;
+      } else if (type == TOKEN_EOF) {
+        state = OPST_ACCEPT;
+      } else {
+        return GRM_NO_MATCH;
+      }
+      break;
+    case OPST_SECOND:
+      if (type == TOKEN_REGISTER) {
+        stored = _set_op_register(is, tok, 1);
+        state = OPST_LAST;
+      } else if (type == TOKEN_NUMBER) {
+        stored = _set_op_number(is, tok, 1);
+        state = OPST_LAST;
+      } else if (type == TOKEN_OFFSET) {
+        state = OPST_OFFSET;
+      } else {
+        return GRM_NO_MATCH;
+      }
+      break;
+    case OPST_OFFSET:
+      NOMATCH_IF_FAIL(type == TOKEN_IDENTIFIER);
+      stored = _set_op_symbol(is, tok, 1, OPS_OFFSET);
+      state = OPST_LAST;
+      break;
+    case OPST_LAST:
+      NOMATCH_IF_FAIL(type == TOKEN_EOF);
+      state = OPST_ACCEPT;
+      break;
+    case OPST_ACCEPT:
+    default:
+      return GRM_NO_MATCH;
+    }
+
+    RETURN_IF_FAIL(stored, GRM_GENERIC_ERROR);
+    tok++; // only EOF leads to OPST_ACCEPT, so the loop stops right after it
   }
 
   return GRM_MATCH;
@@ -636,9 +716,6 @@ static int _set_segment_dup(struct Parsed_Statement *pstmt,
 
   segment->type = INIT_SEG_DUP;
   segment->element_count = segment->data.dup.count; // MUST be set before
-  if (segment->is_uninit == 0) {                    // MUST be set before
-    pstmt->content.data_decl.is_fully_uninit = 0;
-  }
 
   return 1;
 }
@@ -653,7 +730,6 @@ static int _set_segment_number(struct Parsed_Statement *pstmt,
   segment->type = INIT_SEG_VALUE;
   segment->element_count = 1;
   segment->is_uninit = 0;
-  pstmt->content.data_decl.is_fully_uninit = 0;
 
   return 1;
 }
@@ -677,13 +753,13 @@ static int _set_segment_string(struct Parsed_Statement *pstmt,
   RETURN_IF_FAIL(pstmt, 0);
   segment = &pstmt->content.data_decl.segments[segment_idx];
 
-  RETURN_IF_FAIL(_copy_token_value(token, segment->data.string,
-                                   sizeof(segment->data.string)),
-                 0);
+  RETURN_IF_FAIL(token && token->text && token->len > 0, 0);
+  // nothing is copied, the string is appended right from the line later
+  segment->data.string.text = token->text;
+  segment->data.string.len = token->len;
   segment->type = INIT_SEG_STRING;
-  segment->element_count = strlen(segment->data.string);
+  segment->element_count = token->len;
   segment->is_uninit = 0;
-  pstmt->content.data_decl.is_fully_uninit = 0;
 
   return 1;
 }
@@ -701,38 +777,36 @@ static int _set_ops_none(struct Instruction_Statement *is) {
   return 1;
 }
 
-// set is->op[idx] to label of token->value
-static int _set_op_label(struct Instruction_Statement *is,
-                         const struct Token *token, size_t idx) {
+static int _set_op_symbol(struct Instruction_Statement *is,
+                          const struct Token *token, size_t idx,
+                          enum Operand_Specifier specifier) {
   RETURN_IF_FAIL(
       is && token && idx < sizeof(is->operands) / sizeof(struct Operand), 0);
-  RETURN_IF_FAIL(_copy_token_value(token, is->operands[idx].value.label,
-                                   sizeof(is->operands[idx].value.label)),
+  RETURN_IF_FAIL(_token_symbol_id(token, &is->operands[idx].value.symbol_id),
                  0);
   RETURN_IF_FAIL(_set_op_count(is, idx), 0);
+
   is->operands[idx].type = OP_IMM32;
-  is->operands[idx].specifier = OPS_LABEL;
+  is->operands[idx].specifier = (uint8_t)specifier;
 
   return 1;
 }
 
-// set is->op[idx] to register of token->value
+// set is->op[idx] to register code already computed by lexer
 static int _set_op_register(struct Instruction_Statement *is,
                             const struct Token *token, size_t idx) {
   RETURN_IF_FAIL(
       is && token && idx < sizeof(is->operands) / sizeof(struct Operand), 0);
-  RETURN_IF_FAIL(
-      _copy_token_value(token, is->operands[idx].value.register_name,
-                        sizeof(is->operands[idx].value.register_name)),
-      0);
+  RETURN_IF_FAIL(token->id >= 0 && token->id < REG_COUNT, 0);
   RETURN_IF_FAIL(_set_op_count(is, idx), 0);
   is->operands[idx].type = OP_REG;
   is->operands[idx].specifier = OPS_NONE;
+  is->operands[idx].value.reg = (uint8_t)token->id;
 
   return 1;
 }
 
-// set is->op[idx] to number saved in string format in token->value
+// set is->op[idx] to number already computed by lexer
 static int _set_op_number(struct Instruction_Statement *is,
                           const struct Token *token, size_t idx) {
   RETURN_IF_FAIL(
@@ -746,25 +820,11 @@ static int _set_op_number(struct Instruction_Statement *is,
   return 1;
 }
 
-static int _set_op_offset(struct Instruction_Statement *is,
-                          const struct Token *token, size_t idx) {
-  RETURN_IF_FAIL(
-      is && token && idx < sizeof(is->operands) / sizeof(struct Operand), 0);
-  RETURN_IF_FAIL(_copy_token_value(token, is->operands[idx].value.label,
-                                   sizeof(is->operands[idx].value.label)),
-                 0);
-  RETURN_IF_FAIL(_set_op_count(is, idx), 0);
-  is->operands[idx].type = OP_IMM32;
-  is->operands[idx].specifier = OPS_OFFSET;
-
-  return 1;
-}
-
 static int _set_op_count(struct Instruction_Statement *is, size_t idx) {
   RETURN_IF_FAIL(is, 0);
-  RETURN_IF_FAIL(idx < INT_MAX, 0); // idx > sizeof(int)
-  if ((int)(idx + 1) > is->operand_count) {
-    is->operand_count = (int)(idx + 1);
+  RETURN_IF_FAIL(idx < UINT8_MAX, 0); // idx > sizeof(uint8_t)
+  if (idx + 1 > is->operand_count) {
+    is->operand_count = (uint8_t)(idx + 1);
   }
   return 1;
 }
@@ -14,6 +14,8 @@
  *   ! <*dup> are clear violation !
  *   ! <instruction_*> are clear violation !
  * - every possible <line> must be ended by EOF
+ * - first token of a <line> decides its production (LL(1)), so grammar_line
+ * dispatches by it and <instruction_rhs> runs as a single-pass automaton
  *
  * 1) <line> --> <kma_line> | <code_line> | <data_line> | <label_line> |
  * <identifier_line> | <instruction_line> | EOF
@@ -64,85 +66,89 @@ enum Err_Grm {
 // On success return 1 AND fill the pstmt, so the caller must free.
 // On failure return 0 and allocates nothing.
 enum Err_Grm grammar_line(struct Parsed_Statement *pstmt,
-                          const struct Token *tokens[]);
+                          const struct Token *tokens);
 
 // Evaluates whether the array tokens consists of TOKEN_KMA and TOKEN_EOF.
 // On success sets the pstmt adequately and return GRM_MATCH.
 // On failure return GRM_NO_MATCH and the pstmt is unchanged.
 enum Err_Grm grammar_line_kma(struct Parsed_Statement *pstmt,
-                              const struct Token *tokens[]);
+                              const struct Token *tokens);
 
 // Evaluates whether tokens consists of TOKEN_SECTION_CODE and TOKEN_EOF.
 // On success set the pstmt adequately and return GRM_MATCH.
 // On failure return GRM_NO_MATCH and the pstmt is unchanged.
 enum Err_Grm grammar_line_code(struct Parsed_Statement *pstmt,
-                               const struct Token *tokens[]);
+                               const struct Token *tokens);
 
 // Evaluates whether tokens consists of TOKEN_SECTION_DATA and TOKEN_EOF.
 // On success set the pstmt adequately and return GRM_MATCH.
 // On failure return GRM_NO_MATCH and the pstmt is unchanged.
 enum Err_Grm grammar_line_data(struct Parsed_Statement *pstmt,
-                               const struct Token *tokens[]);
+                               const struct Token *tokens);
 
 // Evaluates whether tokens consists of TOKEN_LABEL and TOKEN_EOF.
-// On success return GRM_MATCH and set the pstmt - copying the label name to
-// pstmt. On failure return GRM_NO_MATCH and the pstmt is unchanged.
+// On success return GRM_MATCH and set the pstmt - with the symbol id of the
+// label. On failure return GRM_NO_MATCH and the pstmt is unchanged. If the
+// label name wasn't interned by lexer, return GRM_GENERIC_ERROR and the pstmt
+// is unchanged as well.
 enum Err_Grm grammar_line_label(struct Parsed_Statement *pstmt,
-                                const struct Token *tokens[]);
+                                const struct Token *tokens);
 
 // Evaluates whether tokens array is a data definition statement.
-// On success return GRM_MATCH and set the pstmt, copy identifier name to pstmt
-// and call other functions to fill the insides of pstmt. On failure return
-// GRM_NO_MATCH and the pstmt is unchanged.
+// On success return GRM_MATCH and set the pstmt, with symbol id of the
+// identifier, and call other functions to fill the insides of pstmt. On
+// failure return GRM_NO_MATCH and the pstmt is unchanged. If the identifier
+// wasn't interned by lexer, return GRM_GENERIC_ERROR and the pstmt is
+// unchanged as well.
 enum Err_Grm grammar_line_identifier(struct Parsed_Statement *pstmt,
-                                     const struct Token *tokens[]);
+                                     const struct Token *tokens);
 
 enum Err_Grm grammar_line_instruction(struct Parsed_Statement *pstmt,
-                                      const struct Token *tokens[]);
+                                      const struct Token *tokens);
 
 // Evaluates whether the next token(s) is valid data type and when is, calls
 // other functions to get what the insides are. On success set the pstmt
 // declaration type, call other functions to fill the insides and return
 // GRM_MATCH. On failure return GRM_NO_MATCH and the pstmt is unchanged.
 enum Err_Grm grammar_identifier_def(struct Parsed_Statement *pstmt,
-                                    const struct Token *tokens[]);
+                                    const struct Token *tokens);
 
 // Evaluates whether token(s) is a valid data declaration, based on syntax.
 // On success call other functions to search the rest of tokens, fill one
 // segment in Data_Declaration and return GRM_MATCH. On failure return
 // GRM_NO_MATCH and the pstmt is unchanged.
 enum Err_Grm grammar_identifier_dw_dec(struct Parsed_Statement *pstmt,
-                                       const struct Token *tokens[]);
+                                       const struct Token *tokens);
 
-// Evaluates whether token is comma or eof. If eof, it's success and setting
-// pstmt takes place - based on the pstmt data_decl segment count it is
-// allocated place for segments. If comma, other function for getting the next
-// part is called. On any success return GRM_MATCH. On failure, pstmt is cleared
-// and GRM_NO_MATCH is returned.
+// Evaluates whether token is comma or eof. If comma, the rest of the list is
+// walked in a loop, appending a segment per part and growing the segments
+// geometrically (_reserve_segments) as it goes. If eof, the segments appended
+// so far are finalized. On success return GRM_MATCH. On failure return
+// GRM_NO_MATCH and the segments appended by this call are dropped.
 enum Err_Grm grammar_identifier_dw_dec2(struct Parsed_Statement *pstmt,
-                                        const struct Token *tokens[]);
+                                        const struct Token *tokens);
 
 // Checks if next tokens are valid DUP statement, remember what its parameters
 // are and call other functions to look ahead in the data declaration. On
 // success fills its segment in data_decl with all info and return GRM_MATCH. On
 // failure return GRM_NO_MATCH.
 enum Err_Grm grammar_identifier_dw_dup(struct Parsed_Statement *pstmt,
-                                       const struct Token *tokens[],
+                                       const struct Token *tokens,
                                        size_t segment_idx);
 
 enum Err_Grm grammar_identifier_db_dec(struct Parsed_Statement *pstmt,
-                                       const struct Token *tokens[]);
+                                       const struct Token *tokens);
 
 enum Err_Grm grammar_identifier_db_dec2(struct Parsed_Statement *pstmt,
-                                        const struct Token *tokens[]);
+                                        const struct Token *tokens);
 
 enum Err_Grm grammar_identifier_db_dup(struct Parsed_Statement *pstmt,
-                                       const struct Token *tokens[],
+                                       const struct Token *tokens,
                                        size_t segment_idx);
 
 enum Err_Grm grammar_instruction_rhs(struct Parsed_Statement *pstmt,
-                                     const struct Token *tokens[]);
+                                     const struct Token *tokens);
 
 enum Err_Grm grammar_instruction_rhs_after(struct Parsed_Statement *pstmt,
-                                           const struct Token *tokens[]);
+                                           const struct Token *tokens);
 #endif
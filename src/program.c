@@ -0,0 +1,125 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common.h"
+#include "memory.h"
+#include "parser.h"
+#include "program.h"
+
+// Grow the statement array if needed.
+// Ensures the array have prog->count + additional statements.
+// Return 0 on failure, 1 on success.
+static int _prog_ensure_capacity(struct Program *prog, size_t additional);
+
+struct Program *prog_create(void) {
+  struct Program *prog = NULL;
+  prog = jalloc(sizeof(struct Program));
+  CLEANUP_IF_FAIL(prog);
+
+  prog->count = 0;
+  prog->capacity = PROG_INITIAL_CAPACITY;
+
+  prog->stmts = jalloc(prog->capacity * sizeof(struct Program_Statement));
+  CLEANUP_IF_FAIL(prog->stmts);
+
+  return prog;
+
+cleanup:
+  if (prog) {
+    jree(prog);
+  }
+  return NULL;
+}
+
+void prog_free(struct Program **prog) {
+  if (!prog || !*prog) {
+    return;
+  }
+  prog_clear(*prog);
+  if ((*prog)->stmts) {
+    jree((*prog)->stmts);
+  }
+  jree(*prog);
+  *prog = NULL;
+}
+
+void prog_clear(struct Program *prog) {
+  if (!prog || !prog->stmts) {
+    return;
+  }
+
+  prog->count = 0; // statements own nothing
+}
+
+int prog_app(struct Program *prog, const struct Parsed_Statement *pstmt) {
+  struct Program_Statement *stmt = NULL;
+  CLEANUP_IF_FAIL(prog && prog->stmts && pstmt);
+
+  if (pstmt->type != STMT_INSTRUCTION) {
+    return 1; // nothing to remember for 2nd pass
+  }
+
+  CLEANUP_IF_FAIL(_prog_ensure_capacity(prog, 1));
+  stmt = &prog->stmts[prog->count];
+  stmt->line_number = pstmt->line_number;
+  stmt->instruction = pstmt->content.instruction;
+
+  prog->count++;
+  return 1;
+
+cleanup:
+  return 0;
+}
+
+size_t prog_get_count(const struct Program *prog) {
+  CLEANUP_IF_FAIL(prog);
+
+  return prog->count;
+
+cleanup:
+  return 0;
+}
+
+const struct Program_Statement *prog_get(const struct Program *prog,
+                                         size_t idx) {
+  CLEANUP_IF_FAIL(prog && prog->stmts && idx < prog->count);
+
+  return &prog->stmts[idx];
+
+cleanup:
+  return NULL;
+}
+
+static int _prog_ensure_capacity(struct Program *prog, size_t additional) {
+  size_t req = 0, new_c = 0;
+  struct Program_Statement *new_s = NULL;
+  CLEANUP_IF_FAIL(prog && prog->stmts);
+
+  if (additional == 0) {
+    return 1;
+  }
+
+  CLEANUP_IF_FAIL(prog->count <= SIZE_MAX - additional); // add overflow
+
+  req = prog->count + additional;
+  if (req <= prog->capacity) {
+    return 1; // Already have enough space.
+  }
+
+  new_c = prog->capacity ? prog->capacity : PROG_INITIAL_CAPACITY;
+  while (new_c < req) {
+    CLEANUP_IF_FAIL(new_c <= SIZE_MAX / PROG_CAPACITY_MULT /
+                                 sizeof(struct Program_Statement));
+    new_c *= PROG_CAPACITY_MULT;
+  }
+
+  new_s = jealloc(prog->stmts, new_c * sizeof(struct Program_Statement));
+  CLEANUP_IF_FAIL(new_s); // realloc failed
+
+  prog->stmts = new_s;
+  prog->capacity = new_c;
+  return 1;
+
+cleanup:
+  return 0;
+}
@@ -0,0 +1,50 @@
+#ifndef PROGRAM_H
+#define PROGRAM_H
+
+#include <stddef.h>
+
+#include "parser.h"
+#include "parser_code.h"
+
+#define PROG_INITIAL_CAPACITY 64
+#define PROG_CAPACITY_MULT 2
+
+// One instruction remembered from the 1st pass, which the 2nd pass must emit.
+// Data declarations don't reference symbols, the 1st pass emits them itself.
+struct Program_Statement {
+  size_t line_number;
+  struct Instruction_Statement instruction;
+};
+
+// In-memory representation of the program, built during the 1st pass, so the
+// 2nd pass doesn't have to lex & parse the source again.
+struct Program {
+  struct Program_Statement *stmts; // contiguous array, in source order
+  size_t count;
+  size_t capacity;
+};
+
+// Create new empty Program.
+// Return NULL on failure.
+struct Program *prog_create(void);
+
+// Free program with all statements it owns & set the pointer to NULL.
+void prog_free(struct Program **prog);
+
+// Remove all statements, but keep the allocated capacity for reuse.
+void prog_clear(struct Program *prog);
+
+// Program Append statement. Instruction is copied, other statement types are
+// not needed in 2nd pass and are ignored.
+// Return 1 on success, 0 on failure.
+int prog_app(struct Program *prog, const struct Parsed_Statement *pstmt);
+
+// Program get count of statements.
+size_t prog_get_count(const struct Program *prog);
+
+// Get pointer to idx-th statement. Read-only.
+// Return NULL if out of bounds.
+const struct Program_Statement *prog_get(const struct Program *prog,
+                                         size_t idx);
+
+#endif
@@ -0,0 +1,106 @@
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 199309L // clock_gettime
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#if defined(_WIN32)
+#include <windows.h> // for QueryPerformanceCounter WIN
+#else
+#include <time.h> // for clock_gettime UNIX
+#endif
+
+#include "stats.h"
+
+static const char *const PHASE_NAMES[STATS_PHASE_COUNT] = {
+    [STATS_READ] = "read",       [STATS_LEX] = "lex",
+    [STATS_PARSE] = "parse",     [STATS_PASS1] = "pass1",
+    [STATS_PROGRAM] = "program", [STATS_ENCODE] = "encode",
+    [STATS_FIXUPS] = "fixups",   [STATS_OUTPUT] = "output",
+};
+
+// Return how many of count are done per second in ns nanoseconds, 0 if the
+// time is too short to be measured.
+static double _stats_per_sec(const double count, const uint64_t ns);
+
+uint64_t stats_now(void) {
+#if defined(_WIN32)
+  LARGE_INTEGER freq, now;
+  if (!QueryPerformanceFrequency(&freq) || !QueryPerformanceCounter(&now)) {
+    return 0;
+  }
+  return (uint64_t)((double)now.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+  struct timespec ts;
+  if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+    return 0;
+  }
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+uint64_t stats_lap(struct Stats *stats, enum Stats_Phase phase,
+                   uint64_t start) {
+  uint64_t now = stats_now();
+  if (stats && phase < STATS_PHASE_COUNT && now > start) {
+    stats->ns[phase] += now - start;
+  }
+  return now;
+}
+
+void stats_print(const struct Stats *stats, enum Stats_Format format,
+                 FILE *out) {
+  size_t i = 0;
+  uint64_t total = 0;
+  const double lines = stats ? (double)stats->lines : 0;
+  const double mb = stats ? (double)stats->source_bytes / 1e6 : 0;
+  if (!stats || !out || format == STATS_OFF) {
+    return;
+  }
+  for (i = 0; i < STATS_PHASE_COUNT; i++) {
+    total += stats->ns[i];
+  }
+
+  if (format == STATS_JSON) {
+    fprintf(out,
+            "{\"source_bytes\": %zu, \"lines\": %zu, \"tokens\": %zu, "
+            "\"statements\": %zu, \"symbols\": %zu, \"code_bytes\": %zu, "
+            "\"data_bytes\": %zu, \"total_ns\": %llu, \"phases\": {",
+            stats->source_bytes, stats->lines, stats->tokens,
+            stats->statements, stats->symbols, stats->code_bytes,
+            stats->data_bytes, (unsigned long long)total);
+    for (i = 0; i < STATS_PHASE_COUNT; i++) {
+      fprintf(out,
+              "%s\"%s\": {\"ns\": %llu, \"lines_per_sec\": %.0f, "
+              "\"mb_per_sec\": %.3f}",
+              i ? ", " : "", PHASE_NAMES[i], (unsigned long long)stats->ns[i],
+              _stats_per_sec(lines, stats->ns[i]),
+              _stats_per_sec(mb, stats->ns[i]));
+    }
+    fprintf(out, "}}\n");
+    return;
+  }
+
+  fprintf(out,
+          "Stats: %zu bytes, %zu lines, %zu tokens, %zu statements, "
+          "%zu symbols\n"
+          "       code %zu bytes, data %zu bytes\n",
+          stats->source_bytes, stats->lines, stats->tokens, stats->statements,
+          stats->symbols, stats->code_bytes, stats->data_bytes);
+  fprintf(out, "%-8s %12s %14s %10s\n", "phase", "ms", "lines/s", "MB/s");
+  for (i = 0; i < STATS_PHASE_COUNT; i++) {
+    fprintf(out, "%-8s %12.3f %14.0f %10.2f\n", PHASE_NAMES[i],
+            (double)stats->ns[i] / 1e6, _stats_per_sec(lines, stats->ns[i]),
+            _stats_per_sec(mb, stats->ns[i]));
+  }
+  fprintf(out, "%-8s %12.3f %14.0f %10.2f\n", "total", (double)total / 1e6,
+          _stats_per_sec(lines, total), _stats_per_sec(mb, total));
+}
+
+static double _stats_per_sec(const double count, const uint64_t ns) {
+  if (ns == 0) {
+    return 0;
+  }
+  return count * 1e9 / (double)ns;
+}
@@ -0,0 +1,53 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// How the statistics are reported, chosen by --stats or --stats=json.
+enum Stats_Format {
+  STATS_OFF = 0,
+  STATS_TEXT,
+  STATS_JSON,
+};
+
+// Timed phases of assembling.
+enum Stats_Phase {
+  STATS_READ,    // loading the source file
+  STATS_LEX,     // tokenizing all lines
+  STATS_PARSE,   // parsing tokens of all lines
+  STATS_PASS1,   // deciding parsed statements in 1st pass
+  STATS_PROGRAM, // keeping the statements for 2nd pass
+  STATS_ENCODE,  // encoding instructions, in 2nd pass or right away with -s
+  STATS_FIXUPS,  // patching addresses of forward references, only with -s
+  STATS_OUTPUT,  // writing the binary
+  STATS_PHASE_COUNT,
+};
+
+// Timings & counters of one assembling, all zero initially.
+struct Stats {
+  uint64_t ns[STATS_PHASE_COUNT]; // monotonic time spent in each phase
+  size_t source_bytes;
+  size_t lines;
+  size_t tokens;     // without the EOF of each line
+  size_t statements; // lines with a statement, not empty ones
+  size_t symbols;    // defined ones, not placeholders of references
+  size_t code_bytes;
+  size_t data_bytes;
+};
+
+// Return current time of monotonic clock in nanoseconds, 0 on failure.
+uint64_t stats_now(void);
+
+// Add the time since start to phase. Return the current time, so the next
+// phase can be measured from it.
+uint64_t stats_lap(struct Stats *stats, enum Stats_Phase phase,
+                   uint64_t start);
+
+// Print all counters, time of each phase and its throughput of the source
+// (lines/s & MB/s) into out, as a table or a JSON object.
+void stats_print(const struct Stats *stats, enum Stats_Format format,
+                 FILE *out);
+
+#endif
@@ -9,10 +9,53 @@
 // ===== PRIVATE FUNCTION DEFINITIONS =====
 
 // Grow sym array if needed. Ensures the array have capacity of current +
-// additional_symbols*sizeof(symbol). Return 0 on failure, 1 on success.
+// additional_symbols*sizeof(symbol). Grows the hash index with it.
+// Return 0 on failure, 1 on success.
 static int _symtab_ensure_capacity(struct Symbol_Table *symtab,
                                    size_t additional_symbols);
 
+// Grow the string arena, so additional_bytes can be appended.
+// Return 0 on failure, 1 on success.
+static int _symtab_ensure_names(struct Symbol_Table *symtab,
+                                size_t additional_bytes);
+
+// Append a new symbol record with its name copied into the arena, and put it
+// into slot of the index if it is empty. Capacity must be already ensured.
+// Return pointer to the new symbol, NULL on failure.
+static struct Symbol *_symtab_append(struct Symbol_Table *symtab,
+                                     const char *name, const size_t len,
+                                     const uint32_t hash,
+                                     const uint32_t address,
+                                     const enum Symbol_Kind kind,
+                                     size_t *slot);
+
+// Allocate hash index of index_capacity slots (power of 2) and insert all
+// symbols into it, old index is freed. Return 0 on failure, 1 on success.
+static int _symtab_rehash(struct Symbol_Table *symtab, size_t index_capacity);
+
+// FNV-1a hash of first len characters of name.
+static uint32_t _symtab_hash(const char *name, const size_t len);
+
+// Check if symbol has name of exactly len characters.
+// Return 1 if it has, 0 otherwise.
+static int _symtab_name_eq(const struct Symbol_Table *symtab,
+                           const struct Symbol *symbol, const char *name,
+                           const size_t len, const uint32_t hash);
+
+// Insert symbol with name of exactly len characters (doesn't have to be ended
+// by '\0'), unless it already exists, see symtab_insert_unique.
+static struct Symbol *_symtab_insert_span(struct Symbol_Table *symtab,
+                                          const char *name, const size_t len,
+                                          const uint32_t address,
+                                          const enum Symbol_Kind kind,
+                                          int *inserted);
+
+// Find the index slot of name (with its hash). If the name isn't in table,
+// return the empty slot where it belongs. Index must have an empty slot.
+static size_t *_symtab_probe(const struct Symbol_Table *symtab,
+                             const char *name, const size_t len,
+                             const uint32_t hash);
+
 // ===== PUBLIC FUNCTIONS =====
 
 struct Symbol_Table *symtab_create(void) {
@@ -35,15 +78,28 @@ cleanup:
 int symtab_init(struct Symbol_Table *table) {
   CLEANUP_IF_FAIL(table);
 
+  table->index = NULL;
+  table->index_capacity = 0;
+  table->names = NULL;
   table->symbols = jalloc(SYMTAB_INITIAL_CAPACITY * sizeof(struct Symbol));
   CLEANUP_IF_FAIL(table->symbols);
+  table->names = jalloc(SYMTAB_NAMES_INITIAL_CAPACITY);
+  CLEANUP_IF_FAIL(table->names);
+  table->names_size = 0;
+  table->names_capacity = SYMTAB_NAMES_INITIAL_CAPACITY;
 
   table->count = 0;
   table->capacity = SYMTAB_INITIAL_CAPACITY;
+  CLEANUP_IF_FAIL(_symtab_rehash(
+      table, SYMTAB_INITIAL_CAPACITY * SYMTAB_INDEX_MULT));
 
   return 1;
 
 cleanup:
+  if (table) {
+    jree_clear((void **)&table->symbols);
+    jree_clear((void **)&table->names);
+  }
   return 0;
 }
 
@@ -53,9 +109,21 @@ void symtab_deinit(struct Symbol_Table *table) {
   if (table->symbols) {
     jree(table->symbols);
   }
+  if (table->index) {
+    jree(table->index);
+  }
+  if (table->names) {
+    jree(table->names);
+  }
 
+  table->symbols = NULL;
+  table->index = NULL;
+  table->names = NULL;
   table->count = 0;
   table->capacity = 0;
+  table->index_capacity = 0;
+  table->names_size = 0;
+  table->names_capacity = 0;
 
 cleanup:
   return;
@@ -74,38 +142,73 @@ cleanup:
 
 struct Symbol *symtab_add(struct Symbol_Table *table, const char *name,
                           const uint32_t address) {
-  struct Symbol *symbol = NULL;
+  size_t *slot = NULL;
+  size_t len = 0;
+  uint32_t hash = 0;
   CLEANUP_IF_FAIL(table && table->symbols && name);
-  symbol = &table->symbols[table->count];
+  len = strlen(name);
 
   CLEANUP_IF_FAIL(_symtab_ensure_capacity(table, 1));
+  CLEANUP_IF_FAIL(_symtab_ensure_names(table, len + 1));
+  hash = _symtab_hash(name, len);
+  slot = _symtab_probe(table, name, len, hash);
 
-  symbol->address = address;
-  strcpy(symbol->name, name);
-  table->count++;
-
-  return symbol;
+  // duplicates stay out of index (slot is taken), so first one is found
+  return _symtab_append(table, name, len, hash, address, SYM_UNKNOWN, slot);
 
 cleanup:
   return NULL;
 }
 
-struct Symbol *symtab_find(const struct Symbol_Table *table, const char *name) {
-  size_t i = 0;
+struct Symbol *symtab_insert_unique(struct Symbol_Table *table,
+                                    const char *name, const uint32_t address,
+                                    const enum Symbol_Kind kind,
+                                    int *inserted) {
+  RETURN_IF_FAIL(name, NULL);
+  return _symtab_insert_span(table, name, strlen(name), address, kind,
+                             inserted);
+}
+
+uint32_t symtab_intern(struct Symbol_Table *table, const char *text,
+                       const size_t len) {
   struct Symbol *symbol = NULL;
-  CLEANUP_IF_FAIL(table && table->symbols && name);
+  RETURN_IF_FAIL(table && text && len > 0, UINT32_MAX);
 
-  for (i = 0; i < table->count; i++) {
-    symbol = &table->symbols[i];
-    if (strcmp(symbol->name, name) == 0) {
-      return symbol; // found
-    }
+  symbol = _symtab_insert_span(table, text, len, 0, SYM_UNKNOWN, NULL);
+  RETURN_IF_FAIL(symbol, UINT32_MAX);
+  return (uint32_t)(symbol - table->symbols);
+}
+
+struct Symbol *symtab_find(const struct Symbol_Table *table, const char *name) {
+  size_t len = 0;
+  size_t *slot = NULL;
+  CLEANUP_IF_FAIL(table && table->symbols && table->index && name);
+
+  len = strlen(name);
+  slot = _symtab_probe(table, name, len, _symtab_hash(name, len));
+  if (*slot != 0) {
+    return &table->symbols[*slot - 1]; // found
   }
 
 cleanup:
   return NULL; // not found
 }
 
+struct Symbol *symtab_get(const struct Symbol_Table *table, uint32_t id) {
+  RETURN_IF_FAIL(table && table->symbols && id < table->count, NULL);
+  return &table->symbols[id];
+}
+
+const char *symtab_name(const struct Symbol_Table *table,
+                        const struct Symbol *symbol) {
+  RETURN_IF_FAIL(table && table->names && symbol, NULL);
+  RETURN_IF_FAIL((size_t)symbol->name_offset + symbol->name_len <
+                     table->names_size,
+                 NULL);
+
+  return &table->names[symbol->name_offset];
+}
+
 // ===== PRIVATE FUNCTIONS =====
 
 static int _symtab_ensure_capacity(struct Symbol_Table *symtab,
@@ -133,8 +236,182 @@ static int _symtab_ensure_capacity(struct Symbol_Table *symtab,
 
   symtab->symbols = new_s;
   symtab->capacity = new_cap;
+
+  if (symtab->index_capacity < new_cap * SYMTAB_INDEX_MULT) {
+    CLEANUP_IF_FAIL(_symtab_rehash(symtab, new_cap * SYMTAB_INDEX_MULT));
+  }
+  return 1;
+
+cleanup:
+  return 0;
+}
+
+static int _symtab_ensure_names(struct Symbol_Table *symtab,
+                                size_t additional_bytes) {
+  size_t req = 0, new_cap = 0;
+  char *new_n = NULL;
+  CLEANUP_IF_FAIL(symtab && symtab->names);
+
+  CLEANUP_IF_FAIL(additional_bytes <= UINT32_MAX - symtab->names_size);
+  req = symtab->names_size + additional_bytes; // offsets must fit into 32 bits
+  if (req <= symtab->names_capacity) {
+    return 1;
+  }
+
+  new_cap = symtab->names_capacity ? symtab->names_capacity
+                                   : SYMTAB_NAMES_INITIAL_CAPACITY;
+  while (new_cap < req) {
+    new_cap *= SYMTAB_CAPACITY_MULT;
+  }
+
+  new_n = jealloc(symtab->names, new_cap);
+  CLEANUP_IF_FAIL(new_n);
+
+  symtab->names = new_n;
+  symtab->names_capacity = new_cap;
   return 1;
 
 cleanup:
   return 0;
 }
+
+static struct Symbol *_symtab_append(struct Symbol_Table *symtab,
+                                     const char *name, const size_t len,
+                                     const uint32_t hash,
+                                     const uint32_t address,
+                                     const enum Symbol_Kind kind,
+                                     size_t *slot) {
+  struct Symbol *symbol = NULL;
+  CLEANUP_IF_FAIL(symtab->count < symtab->capacity);
+  CLEANUP_IF_FAIL(len < symtab->names_capacity - symtab->names_size);
+
+  symbol = &symtab->symbols[symtab->count];
+  symbol->hash = hash;
+  symbol->name_offset = (uint32_t)symtab->names_size;
+  symbol->name_len = (uint32_t)len;
+  symbol->address = address;
+  symbol->kind = (uint8_t)kind;
+
+  memcpy(&symtab->names[symtab->names_size], name, len);
+  symtab->names[symtab->names_size + len] = '\0';
+  symtab->names_size += len + 1;
+
+  symtab->count++;
+  if (*slot == 0) {
+    *slot = symtab->count;
+  }
+  return symbol;
+
+cleanup:
+  return NULL;
+}
+
+static int _symtab_rehash(struct Symbol_Table *symtab, size_t index_capacity) {
+  size_t i = 0, pos = 0, mask = 0;
+  size_t *new_index = NULL;
+  const struct Symbol *symbol = NULL;
+  CLEANUP_IF_FAIL(symtab && index_capacity > symtab->count);
+  CLEANUP_IF_FAIL((index_capacity & (index_capacity - 1)) == 0);
+  CLEANUP_IF_FAIL(index_capacity <= SIZE_MAX / sizeof(size_t));
+
+  new_index = jalloc(index_capacity * sizeof(size_t)); // zeroed = all empty
+  CLEANUP_IF_FAIL(new_index);
+
+  mask = index_capacity - 1;
+  for (i = 0; i < symtab->count; i++) {
+    symbol = &symtab->symbols[i];
+    pos = symbol->hash & mask;
+    while (new_index[pos] != 0) {
+      if (_symtab_name_eq(symtab, &symtab->symbols[new_index[pos] - 1],
+                          &symtab->names[symbol->name_offset],
+                          symbol->name_len, symbol->hash)) {
+        break; // duplicate added by symtab_add, keep the first one
+      }
+      pos = (pos + 1) & mask;
+    }
+    if (new_index[pos] == 0) {
+      new_index[pos] = i + 1;
+    }
+  }
+
+  if (symtab->index) {
+    jree(symtab->index);
+  }
+  symtab->index = new_index;
+  symtab->index_capacity = index_capacity;
+  return 1;
+
+cleanup:
+  return 0;
+}
+
+static uint32_t _symtab_hash(const char *name, const size_t len) {
+  uint32_t hash = 2166136261u;
+  size_t i = 0;
+  for (i = 0; i < len; i++) {
+    hash ^= (uint8_t)name[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+static int _symtab_name_eq(const struct Symbol_Table *symtab,
+                           const struct Symbol *symbol, const char *name,
+                           const size_t len, const uint32_t hash) {
+  return symbol->hash == hash && symbol->name_len == len &&
+         memcmp(&symtab->names[symbol->name_offset], name, len) == 0;
+}
+
+static size_t *_symtab_probe(const struct Symbol_Table *symtab,
+                             const char *name, const size_t len,
+                             const uint32_t hash) {
+  const struct Symbol *symbol = NULL;
+  size_t mask = symtab->index_capacity - 1;
+  size_t pos = hash & mask;
+
+  // linear probing, the index is never full, so this always ends
+  while (symtab->index[pos] != 0) {
+    symbol = &symtab->symbols[symtab->index[pos] - 1];
+    if (_symtab_name_eq(symtab, symbol, name, len, hash)) {
+      return &symtab->index[pos];
+    }
+    pos = (pos + 1) & mask;
+  }
+
+  return &symtab->index[pos];
+}
+
+static struct Symbol *_symtab_insert_span(struct Symbol_Table *symtab,
+                                          const char *name, const size_t len,
+                                          const uint32_t address,
+                                          const enum Symbol_Kind kind,
+                                          int *inserted) {
+  struct Symbol *symbol = NULL;
+  size_t *slot = NULL;
+  uint32_t hash = 0;
+  CLEANUP_IF_FAIL(symtab && symtab->symbols && name);
+
+  // grow first, so the probed slot stays valid for insertion
+  CLEANUP_IF_FAIL(_symtab_ensure_capacity(symtab, 1));
+  CLEANUP_IF_FAIL(_symtab_ensure_names(symtab, len + 1));
+  hash = _symtab_hash(name, len);
+  slot = _symtab_probe(symtab, name, len, hash);
+
+  if (*slot != 0) { // already exists
+    if (inserted) {
+      *inserted = 0;
+    }
+    return &symtab->symbols[*slot - 1];
+  }
+
+  symbol = _symtab_append(symtab, name, len, hash, address, kind, slot);
+  CLEANUP_IF_FAIL(symbol);
+
+  if (inserted) {
+    *inserted = 1;
+  }
+  return symbol;
+
+cleanup:
+  return NULL;
+}
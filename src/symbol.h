@@ -6,17 +6,38 @@
 
 #define SYMTAB_INITIAL_CAPACITY 16
 #define SYMTAB_CAPACITY_MULT 2
-#define SYMTAB_MAX_NAME_LEN 256
+// Initial size of the string arena in bytes, grows by SYMTAB_CAPACITY_MULT.
+#define SYMTAB_NAMES_INITIAL_CAPACITY 256
+// Hash index has at least INDEX_MULT times more slots than symbols, so the
+// open-addressing probes stay short. Its capacity is always a power of 2.
+#define SYMTAB_INDEX_MULT 2
 
+// What the symbol names.
+enum Symbol_Kind {
+  SYM_UNKNOWN = 0,
+  SYM_DATA,  // identifier in DATA section, address into data segment
+  SYM_LABEL, // label in CODE section, address into code segment
+};
+
+// Fixed-size record of one symbol, its name lives in the string arena of the
+// table (see symtab_name).
 struct Symbol {
-  char name[SYMTAB_MAX_NAME_LEN];
+  uint32_t hash;        // cached hash of name
+  uint32_t name_offset; // start of name in table->names
+  uint32_t name_len;    // length of name, without '\0'
   uint32_t address;
+  uint8_t kind; // enum Symbol_Kind
 };
 
 struct Symbol_Table {
   struct Symbol *symbols;
   size_t count;
   size_t capacity;
+  char *names; // append-only arena, every name ends by '\0'
+  size_t names_size;
+  size_t names_capacity;
+  size_t *index; // open-addressing slots, symbol position + 1, 0 is empty
+  size_t index_capacity;
 };
 
 // Create a symbol table and initialize it by calling symtab_init. Return
@@ -34,13 +55,40 @@ void symtab_deinit(struct Symbol_Table *table);
 void symtab_free(struct Symbol_Table **table);
 
 // Add a new symbol inside a table. Will COPY the name, so caller retains
-// ownership of the original! Return pointer to newly created symbol on success,
-// NULL on failure.
+// ownership of the original! Duplicate names are allowed, but symtab_find
+// keeps returning the first one. Return pointer to newly created symbol on
+// success, NULL on failure.
 struct Symbol *symtab_add(struct Symbol_Table *table, const char *name,
                           const uint32_t address);
 
+// Add a new symbol of given kind only if its name is not in table yet, with
+// one probe of the hash index. Set *inserted (if not NULL) to 1 if symbol was
+// added, to 0 if it already existed. Return pointer to the new or the existing
+// symbol, NULL on failure. The pointer is valid only until next insertion.
+struct Symbol *symtab_insert_unique(struct Symbol_Table *table,
+                                    const char *name, const uint32_t address,
+                                    const enum Symbol_Kind kind,
+                                    int *inserted);
+
+// Intern the name of exactly len characters (doesn't have to be ended by
+// '\0'): if it isn't in table yet, add it as SYM_UNKNOWN placeholder to be
+// defined later. Return the id of its symbol (see symtab_get), UINT32_MAX on
+// failure.
+uint32_t symtab_intern(struct Symbol_Table *table, const char *text,
+                       const size_t len);
+
 // Find a symbol by its name (mnemonic) in a table.
 // Return pointer to symbol or NULL on failure.
 struct Symbol *symtab_find(const struct Symbol_Table *table, const char *name);
 
+// Get the symbol by its id, the position in table. Ids are dense and stable,
+// so they can be kept instead of names or pointers. Return NULL on failure.
+// The pointer is valid only until next insertion.
+struct Symbol *symtab_get(const struct Symbol_Table *table, uint32_t id);
+
+// Get the NULL-terminated name of symbol from the table.
+// Pointer is valid only until next insertion. Return NULL on failure.
+const char *symtab_name(const struct Symbol_Table *table,
+                        const struct Symbol *symbol);
+
 #endif
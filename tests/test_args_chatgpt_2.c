@@ -1,4 +1,5 @@
 #include "../src/args.h"
+#include "../src/stats.h"
 #include <assert.h>
 #include <stdio.h>
 #include <string.h>
@@ -115,6 +116,36 @@ static void test_parse_invalid_args(void) {
   printf("✅ parse_invalid_args passed.\n");
 }
 
+static void test_parse_stats_flag(void) {
+  print_header("test_parse_stats_flag");
+
+  struct Config cfg;
+  const char *argv_text[3] = {"prog", "src.kas", "--stats"};
+  const char *argv_json[4] = {"prog", "src.kas", "-s", "--stats=json"};
+  const char *argv_none[3] = {"prog", "src.kas", "--statistics"};
+
+  // Flags are read before the source is checked to exist
+  memset(&cfg, 0, sizeof(cfg));
+  (void)args_parse(&cfg, 3, argv_text);
+  assert(cfg.flag_stats == STATS_TEXT);
+  assert(cfg.target && strcmp(cfg.target, "src.kmx") == 0);
+  args_config_deinit(&cfg);
+  assert(cfg.flag_stats == STATS_OFF);
+
+  memset(&cfg, 0, sizeof(cfg));
+  (void)args_parse(&cfg, 4, argv_json);
+  assert(cfg.flag_stats == STATS_JSON);
+  assert(cfg.flag_single_pass == 1);
+  args_config_deinit(&cfg);
+
+  memset(&cfg, 0, sizeof(cfg));
+  (void)args_parse(&cfg, 3, argv_none);
+  assert(cfg.flag_stats == STATS_OFF);
+  args_config_deinit(&cfg);
+
+  printf("✅ parse_stats_flag passed.\n");
+}
+
 // Entry point
 int main(void) {
   printf("Running Args module tests...\n");
@@ -123,6 +154,7 @@ int main(void) {
   test_path_check_syntax();
   test_parse_valid_args();
   test_parse_invalid_args();
+  test_parse_stats_flag();
 
   printf("\nAll tests completed successfully.\n");
   return 0;
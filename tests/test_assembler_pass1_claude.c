@@ -4,6 +4,7 @@
 #include "../src/dataseg.h"
 #include "../src/fileutil.h"
 #include "../src/memory.h"
+#include "../src/program.h"
 #include "../src/symbol.h"
 #include <assert.h>
 #include <stdio.h>
@@ -277,6 +278,40 @@ TEST(data_string_declaration) {
   remove(test_file);
 }
 
+TEST(data_long_string_declaration) {
+  /* Strings aren't limited by any inline buffer, the whole literal is
+   * appended to the data segment exactly as it is in the source */
+  const char *test_file = "asm_data_long_string.asm";
+  static char content[1024];
+  char literal[301];
+  size_t i = 0;
+
+  for (i = 0; i < sizeof(literal) - 1; i++) {
+    literal[i] = (char)('a' + i % 26);
+  }
+  literal[sizeof(literal) - 1] = '\0';
+  snprintf(content, sizeof(content), ".KMA\n.DATA\nmsg DB \"%s\", 0\n",
+           literal);
+
+  assert(create_test_file(test_file, content));
+
+  struct Config *config = create_test_config(test_file, 0);
+  struct Assembler_Processing *asp = asp_create(config, NULL, NULL, NULL);
+  assert(asp != NULL);
+
+  enum Err_Asm result = pass1(asp);
+
+  assert(result == ASM_NO_ERROR);
+  assert(dtsg_get_size(asp->dtsg) == 301);
+  assert(dtsg_flatten(asp->dtsg));
+  assert(memcmp(dtsg_get_bytes(asp->dtsg), literal, 300) == 0);
+  assert(dtsg_get_bytes(asp->dtsg)[300] == 0);
+
+  asp_free(&asp);
+  jree(config);
+  remove(test_file);
+}
+
 /* ==================== CODE SECTION TESTS ==================== */
 
 TEST(instructions_in_code_section) {
@@ -641,6 +676,30 @@ TEST(data_segment_size_limit) {
   remove(test_file);
 }
 
+TEST(data_segment_size_overflow) {
+  /* Sizes which wrap around size_t are still too large, not empty:
+   * 2^62 DWORDs are 2^64 bytes, two times 2^61 DWORDs as well */
+  const char *test_file = "asm_data_overflow.asm";
+  const char *contents[] = {
+      ".KMA\n.DATA\nx DW 4611686018427387904 DUP(0)\n",
+      ".KMA\n.DATA\n"
+      "y DW 2305843009213693952 DUP(?), 2305843009213693952 DUP(?)\n",
+  };
+
+  for (size_t i = 0; i < sizeof(contents) / sizeof(contents[0]); i++) {
+    assert(create_test_file(test_file, contents[i]));
+    struct Config *config = create_test_config(test_file, 0);
+    struct Assembler_Processing *asp = asp_create(config, NULL, NULL, NULL);
+    assert(asp != NULL);
+
+    assert(process_assembler(asp) == ERR_DATA_SEGMENT_TOO_LARGE);
+
+    asp_free(&asp);
+    jree(config);
+    remove(test_file);
+  }
+}
+
 TEST(code_segment_size_limit) {
   /* Test that code segment size limit is enforced
    * KMA specification limits code segment to 256 KB
@@ -709,6 +768,35 @@ TEST(offset_keyword_usage) {
   remove(test_file);
 }
 
+TEST(long_names) {
+  /* Names have no length limit, they are interned & referenced by id */
+  const char *test_file = "asm_long_names.asm";
+  char name[301], label[302];
+  memset(name, 'n', sizeof(name) - 1);
+  name[sizeof(name) - 1] = '\0';
+  label[0] = '@';
+  memset(label + 1, 'l', sizeof(label) - 2);
+  label[sizeof(label) - 1] = '\0';
+
+  FILE *f = fopen(test_file, "w");
+  assert(f != NULL);
+  fprintf(f, ".KMA\n.DATA\n%s DW 42\n.CODE\n", name);
+  fprintf(f, "%s:\nMOV A, OFFSET %s\nJMP %s\n", label, name, label);
+  fclose(f);
+
+  struct Config *config = create_test_config(test_file, 0);
+  struct Assembler_Processing *asp = asp_create(config, NULL, NULL, NULL);
+  assert(asp != NULL);
+
+  assert(process_assembler(asp) == ERR_NO_ERROR);
+  assert(symtab_find(asp->symtab, name) != NULL);
+  assert(symtab_find(asp->symtab, label) != NULL);
+
+  asp_free(&asp);
+  jree(config);
+  remove(test_file);
+}
+
 TEST(no_code_section_error) {
   /* Test that file with no code section fails
    * According to specification, at least one .CODE section is required */
@@ -737,6 +825,90 @@ TEST(no_code_section_error) {
   remove(test_file);
 }
 
+TEST(program_refers_symbols_by_id) {
+  /* Label and OFFSET operands are stored as ids of interned symbols, forward
+   * references get a placeholder which the definition fills later */
+  const char *test_file = "asm_program_ids.asm";
+  const char *content = ".KMA\n"
+                        ".DATA\n"
+                        "msg DB \"hi\", 0\n"
+                        ".CODE\n"
+                        "JMP @end\n"
+                        "MOV C, OFFSET msg\n"
+                        "@end:\n"
+                        "PUSH C\n";
+
+  assert(create_test_file(test_file, content));
+
+  struct Config *config = create_test_config(test_file, 0);
+  struct Assembler_Processing *asp = asp_create(config, NULL, NULL, NULL);
+  assert(asp != NULL);
+
+  assert(pass1(asp) == ASM_NO_ERROR);
+  assert(sizeof(struct Instruction_Statement) <= 32);
+
+  const struct Program_Statement *st = prog_get(asp->program, 0);
+  const struct Symbol *sym =
+      symtab_get(asp->symtab, st->instruction.operands[0].value.symbol_id);
+  assert(sym == symtab_find(asp->symtab, "@end"));
+  assert(sym->kind == SYM_LABEL && sym->address == 5 + 6);
+
+  st = prog_get(asp->program, 1);
+  assert(st->instruction.operands[0].value.reg == REG_C);
+  sym = symtab_get(asp->symtab, st->instruction.operands[1].value.symbol_id);
+  assert(sym == symtab_find(asp->symtab, "msg"));
+  assert(sym->kind == SYM_DATA && sym->address == 0);
+
+  asp_free(&asp);
+  jree(config);
+  remove(test_file);
+}
+
+TEST(program_records_statements) {
+  /* Test that pass 1 remembers exactly the statements pass 2 has to emit
+   * (instructions), in source order, so pass 2 never needs to read the file
+   * again. Data declarations are emitted by pass 1 itself */
+  const char *test_file = "asm_program.asm";
+  const char *content = ".KMA\n"
+                        ".DATA\n"
+                        "var1 DW 1, 2\n"
+                        "; comment only\n"
+                        ".CODE\n"
+                        "@start:\n"
+                        "MOV A, 1\n"
+                        "\n"
+                        "HALT\n";
+
+  assert(create_test_file(test_file, content));
+
+  struct Config *config = create_test_config(test_file, 0);
+  struct Assembler_Processing *asp = asp_create(config, NULL, NULL, NULL);
+  assert(asp != NULL);
+
+  enum Err_Asm result = pass1(asp);
+  assert(result == ASM_NO_ERROR);
+
+  assert(prog_get_count(asp->program) == 2);
+  const struct Program_Statement *st = prog_get(asp->program, 0);
+  assert(st->line_number == 7);
+  assert(st->instruction.descriptor->opcode == 0x10);
+  st = prog_get(asp->program, 1);
+  assert(st->line_number == 9);
+  assert(prog_get(asp->program, 2) == NULL);
+  assert(dtsg_get_size(asp->dtsg) == 8);
+  assert(memcmp(dtsg_get_bytes(asp->dtsg), "\1\0\0\0\2\0\0\0", 8) == 0);
+
+  /* The file may be gone, pass 2 works from memory */
+  remove(test_file);
+  assert(cdsg_begin(asp->cdsg));
+  assert(pass2(asp) == ASM_NO_ERROR);
+  assert(dtsg_get_size(asp->dtsg) == 8);
+  assert(cdsg_get_size(asp->cdsg) == 7);
+
+  asp_free(&asp);
+  jree(config);
+}
+
 /* ==================== MAIN TEST RUNNER ==================== */
 
 int main(void) {
@@ -757,6 +929,7 @@ int main(void) {
   RUN_TEST(duplicate_data_symbol);
   RUN_TEST(data_array_with_dup);
   RUN_TEST(data_string_declaration);
+  RUN_TEST(data_long_string_declaration);
 
   /* Code section tests */
   printf("\n--- Code Section Tests ---\n");
@@ -770,6 +943,9 @@ int main(void) {
   printf("\n--- Mixed Section Tests ---\n");
   RUN_TEST(multiple_section_switches);
   RUN_TEST(realistic_program);
+  RUN_TEST(program_refers_symbols_by_id);
+  RUN_TEST(program_records_statements);
+  RUN_TEST(long_names);
 
   /* Edge case tests */
   printf("\n--- Edge Case Tests ---\n");
@@ -780,6 +956,7 @@ int main(void) {
   /* Size limit tests */
   printf("\n--- Size Limit Tests ---\n");
   RUN_TEST(data_segment_size_limit);
+  RUN_TEST(data_segment_size_overflow);
   RUN_TEST(code_segment_size_limit);
 
   printf("\n========================================\n");
@@ -0,0 +1,351 @@
+#include "../src/assembler.h"
+#include "../src/codeseg.h"
+#include "../src/common.h"
+#include "../src/dataseg.h"
+#include "../src/memory.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Test framework macros */
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name)                                                         \
+  do {                                                                         \
+    printf("Running test: %s\n", #name);                                       \
+    test_##name();                                                             \
+    printf("  PASSED\n");                                                      \
+  } while (0)
+
+/* Helper to create a test file with given content */
+static int create_test_file(const char *filename, const char *content) {
+  FILE *f = fopen(filename, "w");
+  if (!f) {
+    return 0;
+  }
+  fputs(content, f);
+  fclose(f);
+  return 1;
+}
+
+/* Assemble content through both passes, return the main error code */
+static enum Err_Main assemble(char *test_file, const char *content,
+                              struct Config *config,
+                              struct Assembler_Processing **asp) {
+  assert(create_test_file(test_file, content));
+  memset(config, 0, sizeof(*config));
+  config->source = test_file;
+
+  *asp = asp_create(config, NULL, NULL, NULL);
+  assert(*asp != NULL);
+  return process_assembler(*asp);
+}
+
+/* ==================== ENCODING TESTS ==================== */
+
+TEST(encodes_registers_and_immediates) {
+  /* Every operand kind is encoded: opcode, register code, LE imm32 */
+  char test_file[] = "asm_p2_encode.asm";
+  const char *content = ".KMA\n"
+                        ".CODE\n"
+                        "MOV A, 5\n"
+                        "MOV SP, -2\n"
+                        "ADD B, D\n"
+                        "PUSH S\n"
+                        "HALT\n";
+  const uint8_t expected[] = {
+      0x10, 0x00, 0x05, 0x00, 0x00, 0x00, // MOV A, 5
+      0x10, 0x05, 0xFE, 0xFF, 0xFF, 0xFF, // MOV SP, -2
+      0x31, 0x01, 0x03,                   // ADD B, D
+      0x20, 0x04,                         // PUSH S
+      0x00,                               // HALT
+  };
+  struct Config config;
+  struct Assembler_Processing *asp = NULL;
+
+  assert(assemble(test_file, content, &config, &asp) == ERR_NO_ERROR);
+  assert(cdsg_get_size(asp->cdsg) == sizeof(expected));
+  assert(memcmp(cdsg_get_bytes(asp->cdsg), expected, sizeof(expected)) == 0);
+
+  asp_free(&asp);
+  remove(test_file);
+}
+
+TEST(resolves_labels_and_offsets) {
+  /* Forward and backward labels get code addresses, OFFSET gets data ones */
+  char test_file[] = "asm_p2_symbols.asm";
+  const char *content = ".KMA\n"
+                        ".DATA\n"
+                        "x DW 7\n"
+                        "y DW 1, 2\n"
+                        ".CODE\n"
+                        "@start:\n"
+                        "MOV C, OFFSET y\n"
+                        "JMP @end\n"
+                        "JNE @start\n"
+                        "@end:\n"
+                        "HALT\n";
+  const uint8_t expected[] = {
+      0x10, 0x02, 0x04, 0x00, 0x00, 0x00, // MOV C, OFFSET y
+      0x70, 0x10, 0x00, 0x00, 0x00,       // JMP @end
+      0x73, 0x00, 0x00, 0x00, 0x00,       // JNE @start
+      0x00,                               // HALT
+  };
+  struct Config config;
+  struct Assembler_Processing *asp = NULL;
+
+  assert(assemble(test_file, content, &config, &asp) == ERR_NO_ERROR);
+  assert(cdsg_get_size(asp->cdsg) == sizeof(expected));
+  assert(memcmp(cdsg_get_bytes(asp->cdsg), expected, sizeof(expected)) == 0);
+
+  asp_free(&asp);
+  remove(test_file);
+}
+
+TEST(undefined_label_is_unresolved) {
+  /* Jump to label which is never defined is an unresolved reference */
+  char test_file[] = "asm_p2_undefined.asm";
+  const char *content = ".KMA\n"
+                        ".CODE\n"
+                        "JMP @nowhere\n";
+  struct Config config;
+  struct Assembler_Processing *asp = NULL;
+
+  assert(assemble(test_file, content, &config, &asp) ==
+         ERR_UNRESOLVED_REFERENCE);
+
+  asp_free(&asp);
+  remove(test_file);
+}
+
+TEST(offset_of_undefined_is_unresolved) {
+  /* OFFSET of identifier which is never declared is unresolved */
+  char test_file[] = "asm_p2_offset_undefined.asm";
+  const char *content = ".KMA\n"
+                        ".DATA\n"
+                        "x DW 1\n"
+                        ".CODE\n"
+                        "MOV A, OFFSET y\n";
+  struct Config config;
+  struct Assembler_Processing *asp = NULL;
+
+  assert(assemble(test_file, content, &config, &asp) ==
+         ERR_UNRESOLVED_REFERENCE);
+
+  asp_free(&asp);
+  remove(test_file);
+}
+
+/* ==================== SINGLE PASS TESTS ==================== */
+
+TEST(single_pass_matches_two_passes) {
+  /* Forward references are patched by fixups into the same bytes */
+  char test_file[] = "asm_p2_single.asm";
+  const char *content = ".KMA\n"
+                        ".DATA\n"
+                        "x DW 7\n"
+                        ".CODE\n"
+                        "@start:\n"
+                        "JMP @end\n"
+                        "MOV C, OFFSET y\n"
+                        "JNE @start\n"
+                        "JMP @end\n"
+                        "@end:\n"
+                        "HALT\n"
+                        ".DATA\n"
+                        "y DW 1, 2\n";
+  struct Config config;
+  struct Assembler_Processing *asp = NULL, *single = NULL;
+
+  assert(assemble(test_file, content, &config, &asp) == ERR_NO_ERROR);
+
+  config.flag_single_pass = 1;
+  single = asp_create(&config, NULL, NULL, NULL);
+  assert(single != NULL);
+  assert(process_assembler(single) == ERR_NO_ERROR);
+  assert(prog_get_count(single->program) == 0); // nothing kept for pass 2
+  assert(single->fixup_count == 3);             // @end twice, y once
+
+  assert(cdsg_get_size(single->cdsg) == cdsg_get_size(asp->cdsg));
+  assert(memcmp(cdsg_get_bytes(single->cdsg), cdsg_get_bytes(asp->cdsg),
+                cdsg_get_size(asp->cdsg)) == 0);
+  assert(cdsg_get_bytes(single->cdsg)[1] == 21); // JMP @end
+
+  asp_free(&single);
+  asp_free(&asp);
+  remove(test_file);
+}
+
+TEST(single_pass_reports_unresolved) {
+  /* Never defined label and identifier stay unresolved */
+  char test_file[] = "asm_p2_single_undefined.asm";
+  const char *content = ".KMA\n"
+                        ".DATA\n"
+                        "x DW 1\n"
+                        ".CODE\n"
+                        "JMP @nowhere\n"
+                        "MOV A, OFFSET y\n"
+                        "HALT\n";
+  struct Config config;
+  struct Assembler_Processing *asp = NULL;
+
+  assert(create_test_file(test_file, content));
+  memset(&config, 0, sizeof(config));
+  config.source = test_file;
+  config.flag_single_pass = 1;
+
+  asp = asp_create(&config, NULL, NULL, NULL);
+  assert(asp != NULL);
+  assert(process_assembler(asp) == ERR_UNRESOLVED_REFERENCE);
+
+  asp_free(&asp);
+  remove(test_file);
+}
+
+TEST(single_pass_redefinition_fails) {
+  /* Placeholder of forward reference can be defined only once */
+  char test_file[] = "asm_p2_single_redefined.asm";
+  const char *content = ".KMA\n"
+                        ".CODE\n"
+                        "JMP @twice\n"
+                        "@twice:\n"
+                        "@twice:\n"
+                        "HALT\n";
+  struct Config config;
+  struct Assembler_Processing *asp = NULL;
+
+  assert(create_test_file(test_file, content));
+  memset(&config, 0, sizeof(config));
+  config.source = test_file;
+  config.flag_single_pass = 1;
+
+  asp = asp_create(&config, NULL, NULL, NULL);
+  assert(asp != NULL);
+  assert(process_assembler(asp) != ERR_NO_ERROR);
+
+  asp_free(&asp);
+  remove(test_file);
+}
+
+/* ==================== DATA TESTS ==================== */
+
+TEST(data_matches_pass1_layout) {
+  /* Emitted data has exactly the sizes reserved in the 1st pass */
+  char test_file[] = "asm_p2_data.asm";
+  const char *content = ".KMA\n"
+                        ".DATA\n"
+                        "x DW ?\n"
+                        "y DB 1, 2\n"
+                        "z DW -1\n"
+                        ".CODE\n"
+                        "MOV A, OFFSET z\n";
+  const uint8_t expected[] = {0x00, 0x00, 0x00, 0x00, 0x01,
+                              0x02, 0xFF, 0xFF, 0xFF, 0xFF};
+  struct Config config;
+  struct Assembler_Processing *asp = NULL;
+
+  assert(assemble(test_file, content, &config, &asp) == ERR_NO_ERROR);
+  assert(dtsg_get_size(asp->dtsg) == sizeof(expected));
+  assert(cdsg_get_bytes(asp->cdsg)[2] == 6); // OFFSET z
+
+  /* code segment was sized exactly once, between the passes, the
+   * uninitialized DWORD is a run and takes no space in the buffer */
+  assert(asp->dtsg->size == sizeof(expected) - 4);
+  assert(asp->cdsg->capacity == 6);
+
+  assert(dtsg_flatten(asp->dtsg));
+  assert(memcmp(dtsg_get_bytes(asp->dtsg), expected, sizeof(expected)) == 0);
+
+  asp_free(&asp);
+  remove(test_file);
+}
+
+TEST(large_dup_is_kept_as_run) {
+  /* Big uninitialized & DUP data cost no buffer memory until flattened */
+  char test_file[] = "asm_p2_runs.asm";
+  const char *content = ".KMA\n"
+                        ".DATA\n"
+                        "buf DB 100000 DUP(?)\n"
+                        "x DW 3 DUP(258), 9\n"
+                        "y DB \"ok\"\n"
+                        ".CODE\n"
+                        "MOV A, OFFSET y\n";
+  struct Config config;
+  struct Assembler_Processing *asp = NULL;
+  struct Dtsg_Extent ext;
+  const uint8_t *bytes = NULL;
+
+  assert(assemble(test_file, content, &config, &asp) == ERR_NO_ERROR);
+  assert(dtsg_get_size(asp->dtsg) == 100000 + 16 + 2);
+  assert(asp->dtsg->size == 4 + 2); // only the 9 and 'ok'
+  assert(dtsg_get_extent_count(asp->dtsg) == 3);
+  assert(dtsg_get_extent(asp->dtsg, 0, &ext));
+  assert(ext.kind == DTSG_EXT_ZERO && ext.length == 100000);
+  assert(dtsg_get_extent(asp->dtsg, 1, &ext));
+  assert(ext.kind == DTSG_EXT_DWORD && ext.length == 12);
+  assert(dtsg_get_extent(asp->dtsg, 2, &ext));
+  assert(ext.kind == DTSG_EXT_LITERAL && ext.length == 6);
+  assert(cdsg_get_bytes(asp->cdsg)[2] == 0xB0); // OFFSET y = 100016
+  assert(cdsg_get_bytes(asp->cdsg)[3] == 0x86);
+
+  assert(dtsg_flatten(asp->dtsg));
+  bytes = dtsg_get_bytes(asp->dtsg);
+  assert(bytes[99999] == 0);
+  assert(bytes[100000] == 0x02 && bytes[100001] == 0x01);
+  assert(bytes[100008] == 0x02 && bytes[100011] == 0);
+  assert(bytes[100012] == 9 && bytes[100016] == 'o');
+
+  asp_free(&asp);
+  remove(test_file);
+}
+
+TEST(trailing_uninit_is_bss) {
+  /* Only fully uninitialized declarations after the last initialized one */
+  char test_file[] = "asm_p2_bss.asm";
+  const char *content = ".KMA\n"
+                        ".DATA\n"
+                        "a DW ?\n"
+                        "b DB 1\n"
+                        "c DW 10 DUP(?)\n"
+                        "d DB ?, ?\n"
+                        ".CODE\n"
+                        "HALT\n";
+  struct Config config;
+  struct Assembler_Processing *asp = NULL;
+
+  assert(assemble(test_file, content, &config, &asp) == ERR_NO_ERROR);
+  assert(dtsg_get_size(asp->dtsg) == 4 + 1 + 40 + 2);
+  assert(asp->bss_size == 40 + 2);
+
+  asp_free(&asp);
+  remove(test_file);
+}
+
+int main(void) {
+  printf("========================================\n");
+  printf("Running Assembler Pass 2 Test Suite\n");
+  printf("========================================\n\n");
+
+  printf("--- Encoding Tests ---\n");
+  RUN_TEST(encodes_registers_and_immediates);
+  RUN_TEST(resolves_labels_and_offsets);
+  RUN_TEST(undefined_label_is_unresolved);
+  RUN_TEST(offset_of_undefined_is_unresolved);
+
+  printf("\n--- Single Pass Tests ---\n");
+  RUN_TEST(single_pass_matches_two_passes);
+  RUN_TEST(single_pass_reports_unresolved);
+  RUN_TEST(single_pass_redefinition_fails);
+
+  printf("\n--- Data Tests ---\n");
+  RUN_TEST(data_matches_pass1_layout);
+  RUN_TEST(large_dup_is_kept_as_run);
+  RUN_TEST(trailing_uninit_is_bss);
+
+  printf("\n========================================\n");
+  printf("All tests passed!\n");
+  printf("========================================\n");
+
+  assert(jemory() == 0);
+  return 0;
+}
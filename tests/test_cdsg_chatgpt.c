@@ -142,6 +142,38 @@ static void test_advance_and_write(void) {
   printf("✅ advance_and_write passed.\n");
 }
 
+static void test_begin_presizes(void) {
+  print_header("test_begin_presizes");
+
+  struct Code_Segment *seg = cdsg_create();
+  assert(seg);
+
+  // 1st pass only counts, nothing fits before the buffer is sized
+  assert(cdsg_advance(seg, 1000) == 0);
+  assert(cdsg_advance(seg, 6) == 1000);
+  assert(seg->size > seg->capacity);
+  assert(!cdsg_fits(seg, 0) && !cdsg_fits(seg, 1));
+
+  // capacity is exactly the final size
+  assert(cdsg_begin(seg));
+  assert(cdsg_get_size(seg) == 0);
+  assert(seg->capacity == 1006);
+  assert(cdsg_fits(seg, 1006));
+  assert(!cdsg_fits(seg, 1007));
+
+  // 2nd pass writes without growing
+  uint8_t *bytes = seg->bytes;
+  uint8_t *slice = cdsg_reserve_unchecked(seg, 1000);
+  assert(slice == bytes);
+  slice = cdsg_reserve_unchecked(seg, 6);
+  assert(slice == bytes + 1000);
+  assert(!cdsg_fits(seg, 1));
+  assert(seg->bytes == bytes && seg->capacity == 1006);
+
+  cdsg_free(&seg);
+  printf("✅ begin_presizes passed.\n");
+}
+
 // --- MAIN ---
 
 int main(void) {
@@ -153,6 +185,7 @@ int main(void) {
   test_append_opcode_reg_imm();
   test_capacity_growth();
   test_advance_and_write();
+  test_begin_presizes();
 
   printf("\nAll Code Segment tests passed successfully.\n");
   return 0;
@@ -78,14 +78,13 @@ static void test_append_string_and_zeroes(void) {
   assert(d != NULL);
 
   const char *s = "hello";
-  // append string - should include terminating null according to header comment
+  // append string - the terminating null is NOT appended (see dataseg.h)
   assert(dtsg_app_str(d, s) == 1);
   size_t sz = dtsg_get_size(d);
   const uint8_t *p = bytes(d);
-  // check 'h','e','l','l','o','\0'
-  assert(sz >= 6);
+  // check 'h','e','l','l','o'
+  assert(sz == 5);
   assert(memcmp(p, "hello", 5) == 0);
-  assert(p[5] == 0);
 
   // append 4 zero bytes
   assert(dtsg_app_zs(d, 4) == 1);
@@ -122,28 +121,93 @@ static void test_capacity_growth_and_large_append(void) {
   printf("  PASSED\n");
 }
 
-static void test_advance_behavior(void) {
-  printf("Testing dtsg_advance behavior...\n");
+static void test_pattern_fill(void) {
+  printf("Testing pattern fill (DUP)...\n");
   struct Data_Segment *d = dtsg_create();
   assert(d != NULL);
 
-  // first advance by 10 -> should return offset 0 and size becomes 10
-  size_t off1 = dtsg_advance(d, 10);
-  assert(off1 != SIZE_MAX);
-  assert(off1 == 0);
-  assert(dtsg_get_size(d) >= 10);
-
-  // second advance by 5 -> should return old size (10) and size becomes 15
-  size_t off2 = dtsg_advance(d, 5);
-  assert(off2 != SIZE_MAX);
-  assert(off2 == off1 + 10);
-  assert(dtsg_get_size(d) >= 15);
-
-  // appending after advance appends after advanced region
-  assert(dtsg_app_b(d, 0xAB) == 1);
-  size_t final_size = dtsg_get_size(d);
+  // odd count and pattern straddling the capacity growth
+  size_t n = DTSG_INITIAL_CAPACITY + 7;
+  assert(dtsg_app_b(d, 0x11) == 1);
+  assert(dtsg_app_dw_n(d, 0x04030201, n) == 1);
+  assert(dtsg_get_size(d) == 1 + n * 4);
   const uint8_t *p = bytes(d);
-  assert(p[final_size - 1] == 0xAB);
+  for (size_t i = 0; i < n * 4; ++i) {
+    assert(p[1 + i] == (uint8_t)(1 + i % 4));
+  }
+
+  // zero byte is a valid fill value, zero count is a no-op
+  size_t sz = dtsg_get_size(d);
+  assert(dtsg_app_b_n(d, 0, 3) == 1);
+  assert(dtsg_app_b_n(d, 0xCD, 0) == 1);
+  assert(dtsg_get_size(d) == sz + 3);
+  p = bytes(d);
+  assert(p[sz] == 0 && p[sz + 2] == 0);
+
+  // generic pattern of 3 bytes
+  const uint8_t pat[] = {'a', 'b', 'c'};
+  sz = dtsg_get_size(d);
+  assert(dtsg_app_pattern(d, pat, sizeof(pat), 5) == 1);
+  assert(dtsg_get_size(d) == sz + 15);
+  p = bytes(d);
+  assert(memcmp(p + sz, "abcabcabcabcabc", 15) == 0);
+
+  // invalid arguments
+  assert(dtsg_app_pattern(d, pat, 0, 5) == 0);
+  assert(dtsg_app_pattern(d, NULL, 3, 5) == 0);
+  assert(dtsg_app_pattern(d, pat, 2, SIZE_MAX) == 0);
+
+  dtsg_free(&d);
+  printf("  PASSED\n");
+}
+
+static void test_extents(void) {
+  printf("Testing extents of runs...\n");
+  struct Data_Segment *d = dtsg_create();
+  struct Dtsg_Extent e;
+  assert(d != NULL);
+  assert(dtsg_use_extents(d) == 1);
+
+  assert(dtsg_app_b(d, 0x11) == 1);
+  assert(dtsg_app_zs(d, 1000) == 1);
+  assert(dtsg_app_dw_n(d, 0, 250) == 1);        // merged into zero run
+  assert(dtsg_app_dw_n(d, 0x04030201, 3) == 1); // DWord run
+  assert(dtsg_app_b_n(d, 0xEE, 5) == 1);        // byte run
+  assert(dtsg_app_dw(d, -1) == 1);              // trailing literal
+
+  assert(dtsg_get_size(d) == 1 + 2000 + 12 + 5 + 4);
+  assert(d->size == 5); // only literal bytes are in buffer
+  assert(dtsg_get_bytes(d) == NULL);
+  assert(dtsg_get_extent_count(d) == 5);
+  assert(dtsg_get_extent(d, 0, &e) && e.kind == DTSG_EXT_LITERAL);
+  assert(e.start == 0 && e.length == 1);
+  assert(dtsg_get_extent(d, 1, &e) && e.kind == DTSG_EXT_ZERO);
+  assert(e.length == 2000);
+  assert(dtsg_get_extent(d, 2, &e) && e.kind == DTSG_EXT_DWORD);
+  assert(e.length == 12);
+  assert(dtsg_get_extent(d, 3, &e) && e.kind == DTSG_EXT_BYTE);
+  assert(e.length == 5 && e.pattern[0] == 0xEE);
+  assert(dtsg_get_extent(d, 4, &e) && e.kind == DTSG_EXT_LITERAL);
+  assert(e.start == 1 && e.length == 4);
+  assert(dtsg_get_extent(d, 5, &e) == 0);
+
+  // materialize
+  assert(dtsg_flatten(d) == 1);
+  assert(d->extents == NULL);
+  assert(dtsg_get_size(d) == 2022);
+  const uint8_t *p = bytes(d);
+  assert(p != NULL);
+  assert(p[0] == 0x11 && p[1] == 0 && p[2000] == 0);
+  assert(p[2001] == 1 && p[2004] == 4 && p[2012] == 4);
+  assert(p[2013] == 0xEE && p[2017] == 0xEE);
+  assert(p[2018] == 0xFF && p[2021] == 0xFF);
+
+  // flat segment is one literal extent
+  assert(dtsg_get_extent_count(d) == 1);
+  assert(dtsg_get_extent(d, 0, &e) && e.length == 2022);
+
+  // non-empty segment can't switch
+  assert(dtsg_use_extents(d) == 0);
 
   dtsg_free(&d);
   printf("  PASSED\n");
@@ -156,7 +220,8 @@ int main(void) {
   test_append_dword_and_dws();
   test_append_string_and_zeroes();
   test_capacity_growth_and_large_append();
-  test_advance_behavior();
+  test_pattern_fill();
+  test_extents();
   printf("\n=== All Data_Segment Tests Passed ===\n\n");
   return 0;
 }
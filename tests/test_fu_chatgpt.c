@@ -137,6 +137,56 @@ static void test_invalid_inputs(void) {
   printf("✅ invalid_inputs (no crash) passed.\n");
 }
 
+static void test_source_lines(void) {
+  print_header("test_source_lines");
+
+  cleanup();
+  FILE *f = fopen(TMP_FILE, "w");
+  assert(f);
+  fputs(".KMA\n\nMOV A, 1\r\nHALT", f); // last line without '\n'
+  fclose(f);
+
+  struct Fu_Source *src = fu_source_create(TMP_FILE);
+  assert(src != NULL);
+
+  struct Fu_Line line = {0};
+  assert(fu_source_next_line(src, &line) == 1);
+  assert(line.number == 1 && line.len == 4);
+  assert(strncmp(line.text, ".KMA", 4) == 0);
+
+  assert(fu_source_next_line(src, &line) == 1);
+  assert(line.number == 2 && line.len == 0);
+
+  assert(fu_source_next_line(src, &line) == 1);
+  assert(line.number == 3 && line.len == 9); // '\r' stays in the view
+  assert(strncmp(line.text, "MOV A, 1", 8) == 0);
+
+  assert(fu_source_next_line(src, &line) == 1);
+  assert(line.number == 4 && line.len == 4);
+  assert(strncmp(line.text, "HALT", 4) == 0);
+
+  assert(fu_source_next_line(src, &line) == 0);
+
+  fu_source_free(&src);
+  assert(src == NULL);
+
+  // empty file is valid source without lines
+  create_file(TMP_FILE);
+  f = fopen(TMP_FILE, "w");
+  assert(f);
+  fclose(f);
+  src = fu_source_create(TMP_FILE);
+  assert(src != NULL);
+  struct Fu_Line empty = {0};
+  assert(fu_source_next_line(src, &empty) == 0);
+  fu_source_free(&src);
+
+  assert(fu_source_create(NON_EXISTENT) == NULL);
+  assert(fu_source_create(NULL) == NULL);
+
+  printf("✅ source_lines passed.\n");
+}
+
 // --- MAIN ---
 int main(void) {
   printf("Running File Util tests...\n");
@@ -148,6 +198,7 @@ int main(void) {
   test_can_write_dir();
   test_can_write_parent_dir();
   test_invalid_inputs();
+  test_source_lines();
 
   cleanup();
   printf("\nAll File Util tests passed successfully.\n");
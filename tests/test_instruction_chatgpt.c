@@ -45,6 +45,28 @@ int main(void) {
   assert(desc == NULL);
   printf("✅ instruction_find() tests passed.\n");
 
+  // === Test 2b: mnemonic IDs ===
+  TEST("instruction_mnemonic_id()");
+  assert(instruction_mnemonic_id("JE", 2) == MNEM_JE);
+  assert(instruction_mnemonic_id("JNL", 3) == MNEM_JNL);
+  assert(instruction_mnemonic_id("MOVSD", 5) == MNEM_MOVSD);
+  assert(instruction_mnemonic_id("MOVSDX", 5) == MNEM_MOVSD); // prefix only
+  assert(instruction_mnemonic_id("MOVSDX", 6) == MNEM_NONE);
+  assert(instruction_mnemonic_id("mov", 3) == MNEM_NONE); // case sensitive
+  assert(instruction_mnemonic_id("J", 1) == MNEM_NONE);
+
+  desc = instruction_find_id(MNEM_ADD, OP_REG, OP_REG);
+  assert(desc != NULL && desc->opcode == 0x31 && desc->id == MNEM_ADD);
+  assert(instruction_find_id(MNEM_NONE, OP_NONE, OP_NONE) == NULL);
+  assert(instruction_find_id(MNEM_RET, OP_REG, OP_NONE) == NULL); // hole
+  assert(instruction_find_id(MNEM_COUNT, OP_NONE, OP_NONE) == NULL);
+
+  // sizes are precomputed in the table
+  desc = instruction_find_id(MNEM_MOV, OP_REG, OP_IMM32);
+  assert(desc != NULL && desc->size == 6);
+  assert(instruction_get_encoded_size(desc) == 6);
+  printf("✅ Mnemonic ID tests passed.\n");
+
   // === Test 3: Encoded size ===
   TEST("instruction_get_encoded_size()");
 
@@ -37,10 +37,10 @@ int main(void) {
 
   assert(t0 && t1 && t2);
   assert(t0->type == TOKEN_INSTRUCTION);
-  assert(strcmp(t0->value, "MOV") == 0);
+  assert(lexer_token_eq(t0, "MOV"));
 
   assert(t1->type == TOKEN_REGISTER);
-  assert(strcmp(t1->value, "A") == 0);
+  assert(lexer_token_eq(t1, "A"));
 
   assert(t2->type == TOKEN_COMMA);
   printf("First 3 tokens verified (MOV, A, ,)\n");
@@ -1,7 +1,10 @@
 // tests/test_lexer_all.c
+#include "../src/instruction.h"
 #include "../src/lexer.h"
 #include "../src/memory.h"
+#include "../src/symbol.h"
 #include <assert.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -26,7 +29,7 @@ static size_t token_count(const struct Token *tokens) {
     assert(tok != NULL);                                                       \
     assert(tok->type == (type_val));                                           \
     if ((val_str) != NULL)                                                     \
-      assert(strcmp(tok->value, (val_str)) == 0);                              \
+      assert(lexer_token_eq(tok, (val_str)));                              \
   } while (0)
 
 /* Macro: create token array from lexer */
@@ -81,7 +84,7 @@ static void test_registers(void) {
   }
 
   struct Token *tok_sp = TOK_AT(tokens, 5);
-  assert(strcmp(tok_sp->value, "SP") == 0);
+  assert(lexer_token_eq(tok_sp, "SP"));
 
   lexer_free_tokens(tokens);
   printf("  PASSED\n");
@@ -247,7 +250,7 @@ static void test_comments(void) {
   struct Token *last_real_token = TOK_AT(tokens, 3);
   assert(last_real_token != NULL);
   assert(last_real_token->type == TOKEN_NUMBER);
-  assert(strcmp(last_real_token->value, "5") == 0);
+  assert(lexer_token_eq(last_real_token, "5"));
 
   lexer_free_tokens(tokens);
   printf("  PASSED\n");
@@ -338,6 +341,91 @@ static void test_various_whitespace(void) {
   printf("  PASSED\n");
 }
 
+static void test_spans_and_numbers(void) {
+  printf("Testing zero-copy spans and number values...\n");
+  char line[400];
+  memset(line, 'x', 300); // identifier longer than any old fixed buffer
+  strcpy(line + 300, " 2147483647 -42 99999999999999999999999");
+  struct Token *tokens = LEXER_TOKENS(line, 3);
+  assert(tokens != NULL);
+  assert(token_count(tokens) == 5);
+
+  ASSERT_TOKEN(tokens, 0, TOKEN_IDENTIFIER, NULL);
+  assert(tokens[0].text == line); // points into the line, no copy
+  assert(tokens[0].len == 300);
+
+  ASSERT_TOKEN(tokens, 1, TOKEN_NUMBER, "2147483647");
+  assert(tokens[1].number == 2147483647);
+  ASSERT_TOKEN(tokens, 2, TOKEN_NUMBER, "-42");
+  assert(tokens[2].number == -42);
+  assert(tokens[3].type == TOKEN_NUMBER);
+  assert(tokens[3].number == INT64_MAX); // saturated
+
+  lexer_free_tokens(tokens);
+
+  // line doesn't have to be NULL-terminated
+  tokens = lexer_tokenize_span("INC A, B", 5, 1, NULL);
+  assert(tokens != NULL);
+  assert(token_count(tokens) == 3);
+  ASSERT_TOKEN(tokens, 0, TOKEN_INSTRUCTION, "INC");
+  ASSERT_TOKEN(tokens, 1, TOKEN_REGISTER, "A");
+  lexer_free_tokens(tokens);
+  printf("  PASSED\n");
+}
+
+static void test_word_ids(void) {
+  printf("Testing keyword and mnemonic IDs...\n");
+  struct Token *tokens = LEXER_TOKENS("JNE SP, DWORD DB BYTE x", 1);
+  assert(tokens != NULL);
+  ASSERT_TOKEN(tokens, 0, TOKEN_INSTRUCTION, "JNE");
+  assert(tokens[0].id == MNEM_JNE);
+  ASSERT_TOKEN(tokens, 1, TOKEN_REGISTER, "SP");
+  assert(tokens[1].id == REG_SP);
+  assert(tokens[3].id == KW_DWORD);
+  assert(tokens[4].id == KW_BYTE);
+  assert(tokens[5].id == KW_BYTE);
+  ASSERT_TOKEN(tokens, 6, TOKEN_IDENTIFIER, "x");
+  assert(tokens[6].id == TOKEN_NO_ID); // not interned without symtab
+  lexer_free_tokens(tokens);
+
+  // tokens made by hand get the same id
+  struct Token tok;
+  assert(lexer_token_init(&tok, TOKEN_REGISTER, "D", 1, 1));
+  assert(tok.id == REG_D);
+  printf("  PASSED\n");
+}
+
+static void test_interned_names(void) {
+  printf("Testing interning of labels and identifiers...\n");
+  struct Symbol_Table *symtab = symtab_create();
+  assert(symtab != NULL);
+
+  const char *first = "JMP @loop";
+  struct Token *tokens =
+      lexer_tokenize_span(first, strlen(first), 1, symtab);
+  assert(tokens != NULL);
+  assert(tokens[0].id == MNEM_JMP); // other ids stay as they were
+  ASSERT_TOKEN(tokens, 1, TOKEN_LABEL, "@loop");
+  int loop_id = tokens[1].id;
+  lexer_free_tokens(tokens);
+
+  // same name gets the same id, the symbol is a placeholder until defined
+  const char *second = "@loop MOV A, OFFSET msg @loop";
+  tokens = lexer_tokenize_span(second, strlen(second), 2, symtab);
+  assert(tokens != NULL);
+  assert(tokens[0].id == loop_id && tokens[6].id == loop_id);
+  ASSERT_TOKEN(tokens, 5, TOKEN_IDENTIFIER, "msg");
+  assert(tokens[5].id != loop_id);
+  assert(symtab->count == 2);
+  struct Symbol *msg = symtab_get(symtab, (uint32_t)tokens[5].id);
+  assert(msg != NULL && msg->kind == SYM_UNKNOWN);
+  assert(strcmp(symtab_name(symtab, msg), "msg") == 0);
+  lexer_free_tokens(tokens);
+
+  symtab_free(&symtab);
+  printf("  PASSED\n");
+}
+
 /* ---------- Main ---------- */
 int main(void) {
   printf("\n=== Running Lexer Unit Tests (array interface).");
@@ -360,6 +448,9 @@ int main(void) {
   test_comment_only_line();
   test_dup_syntax();
   test_offset_usage();
+  test_spans_and_numbers();
+  test_word_ids();
+  test_interned_names();
   test_instruction_prefixes();
   test_various_whitespace();
 
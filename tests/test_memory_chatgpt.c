@@ -119,6 +119,115 @@ static void test_invalid_inputs(void) {
   printf("✅ invalid_inputs passed.\n");
 }
 
+static void test_arena_bump_and_reset(void) {
+  print_header("test_arena_bump_and_reset");
+
+  size_t before = jemory();
+  struct Jarena arena;
+  struct Jarena_Mark start, line;
+  assert(jarena_init(&arena, 256));
+  assert(jemory() == before); // blocks are allocated lazily
+  jarena_mark(&arena, &start);
+
+  char *a = jarena_alloc(&arena, 10);
+  assert(a != NULL && a[0] == 0 && a[9] == 0);
+  char *b = jarena_alloc_raw(&arena, 3);
+  assert(b != NULL && b >= a + 10);
+  assert((size_t)b % JARENA_ALIGN == 0);
+  assert(jemory() == before + 1); // one block for both
+
+  // per-line reset point, the same memory is handed out again
+  jarena_mark(&arena, &line);
+  char *c = jarena_alloc(&arena, 100);
+  memset(c, 'x', 100);
+  jarena_reset(&arena, &line);
+  assert(jarena_alloc(&arena, 100) == c);
+  assert(c[0] == 0); // zeroed again
+
+  // larger than block size gets its own block, kept after reset
+  void *big = jarena_alloc_raw(&arena, 1000);
+  assert(big != NULL);
+  size_t blocks = jemory();
+  jarena_reset(&arena, &start);
+  assert(jarena_alloc_raw(&arena, 10) == a);
+  assert(jarena_alloc_raw(&arena, 1000) != NULL);
+  assert(jemory() == blocks); // no new block was needed
+
+  assert(jarena_alloc(&arena, 0) == NULL);
+  assert(jarena_alloc(NULL, 8) == NULL);
+
+  jarena_deinit(&arena);
+  assert(jemory() == before);
+  printf("✅ arena_bump_and_reset passed.\n");
+}
+
+static void test_arena_grow(void) {
+  print_header("test_arena_grow");
+
+  struct Jarena arena;
+  assert(jarena_init(&arena, 256));
+
+  // the most recent allocation grows in place
+  char *p = jarena_grow(&arena, NULL, 0, 8);
+  assert(p != NULL);
+  memcpy(p, "abcdefgh", 8);
+  assert(jarena_grow(&arena, p, 8, 64) == p);
+
+  // anything allocated after it forces a copy
+  char *q = jarena_alloc(&arena, 8);
+  assert(q != NULL);
+  char *r = jarena_grow(&arena, p, 64, 128);
+  assert(r != NULL && r != p);
+  assert(memcmp(r, "abcdefgh", 8) == 0);
+
+  // growing past the block moves to a new one
+  char *s = jarena_grow(&arena, r, 128, 4096);
+  assert(s != NULL && memcmp(s, "abcdefgh", 8) == 0);
+
+  jarena_deinit(&arena);
+  assert(jemory() == 0);
+  printf("✅ arena_grow passed.\n");
+}
+
+static void test_profile_report(void) {
+  print_header("test_profile_report");
+
+  struct Jarena arena;
+  char line[256];
+  int heap_site = 0, arena_site = 0, lines = 0;
+  FILE *out = tmpfile();
+  assert(out != NULL);
+  assert(jarena_init(&arena, 0));
+  void *mem = jalloc(100);
+  assert(mem != NULL);
+  assert(jarena_alloc(&arena, 40) != NULL);
+
+  // both are charged to this file, not to the arena block inside memory.c
+  jemory_report(out);
+  rewind(out);
+  while (fgets(line, sizeof(line), out)) {
+    lines++;
+    if (strstr(line, "test_memory_chatgpt.c")) {
+      if (strstr(line, " arena ")) {
+        arena_site = 1;
+      } else {
+        heap_site = 1;
+      }
+    }
+  }
+#ifdef JEMORY_PROFILE
+  assert(heap_site && arena_site);
+#else
+  assert(lines == 0 && !heap_site && !arena_site);
+#endif
+
+  fclose(out);
+  jree(mem);
+  jarena_deinit(&arena);
+  assert(jemory() == 0);
+  printf("✅ profile_report passed.\n");
+}
+
 // --- MAIN ---
 
 int main(void) {
@@ -131,6 +240,9 @@ int main(void) {
   test_strn_duplicate();
   test_multiple_allocations();
   test_invalid_inputs();
+  test_arena_bump_and_reset();
+  test_arena_grow();
+  test_profile_report();
 
   printf("\nAll Jemory tests passed successfully.\n");
   return 0;
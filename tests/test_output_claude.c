@@ -0,0 +1,181 @@
+#include "../src/assembler.h"
+#include "../src/codeseg.h"
+#include "../src/common.h"
+#include "../src/dataseg.h"
+#include "../src/memory.h"
+#include "../src/output.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Test framework macros */
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name)                                                         \
+  do {                                                                         \
+    printf("Running test: %s\n", #name);                                       \
+    test_##name();                                                             \
+    printf("  PASSED\n");                                                      \
+  } while (0)
+
+/* Read the whole file into buf, return number of bytes read */
+static size_t read_file(const char *filename, uint8_t *buf, size_t max) {
+  size_t n = 0;
+  FILE *f = fopen(filename, "rb");
+  if (!f) {
+    return 0;
+  }
+  n = fread(buf, 1, max, f);
+  fclose(f);
+  return n;
+}
+
+/* ==================== OUTPUT TESTS ==================== */
+
+TEST(writes_header_and_segments) {
+  /* Header is followed by code segment, then data segment */
+  char target[] = "out_segments.kmx";
+  struct Config config = {0};
+  struct Assembler_Processing *asp = NULL;
+  const uint8_t code[] = {0x10, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00};
+  const uint8_t data[] = {'h', 'i', 0x00};
+  const uint8_t expected[] = {
+      'K',  'M', 'A', KMX_VERSION, // magic & version
+      7,    0,   0,   0,           // code size
+      3,    0,   0,   0,           // data size
+      0,    0,   0,   0,           // BSS size
+      0x10, 0,   5,   0,    0, 0, 0x00, 'h', 'i', 0,
+  };
+  uint8_t buf[64];
+
+  config.target = target;
+  asp = asp_create(&config, NULL, NULL, NULL);
+  assert(asp != NULL);
+  assert(cdsg_app_bs(asp->cdsg, code, sizeof(code)));
+  assert(dtsg_app_bs(asp->dtsg, data, sizeof(data)));
+
+  assert(output_binary(asp) == ERR_NO_ERROR);
+  assert(read_file(target, buf, sizeof(buf)) == sizeof(expected));
+  assert(memcmp(buf, expected, sizeof(expected)) == 0);
+
+  asp_free(&asp);
+  remove(target);
+}
+
+TEST(replaces_existing_target) {
+  /* Existing file is replaced as a whole, even if it was longer */
+  char target[] = "out_replace.kmx";
+  struct Config config = {0};
+  struct Assembler_Processing *asp = NULL;
+  uint8_t buf[64];
+  FILE *f = fopen(target, "wb");
+  assert(f != NULL);
+  fputs("some much longer previous content of the file", f);
+  fclose(f);
+
+  config.target = target;
+  asp = asp_create(&config, NULL, NULL, NULL);
+  assert(asp != NULL);
+
+  assert(output_binary(asp) == ERR_NO_ERROR);
+  assert(read_file(target, buf, sizeof(buf)) == KMX_HEADER_SIZE);
+  assert(memcmp(buf, KMX_MAGIC, 3) == 0);
+
+  asp_free(&asp);
+  remove(target);
+}
+
+TEST(streams_data_runs) {
+  /* Runs are written in blocks, the file equals the flattened segment */
+  char target[] = "out_runs.kmx";
+  struct Config config = {0};
+  struct Assembler_Processing *asp = NULL;
+  static uint8_t buf[KMX_HEADER_SIZE + 20000];
+  size_t i = 0;
+
+  config.target = target;
+  asp = asp_create(&config, NULL, NULL, NULL);
+  assert(asp != NULL);
+  assert(dtsg_app_b(asp->dtsg, 'a'));
+  assert(dtsg_app_dw_n(asp->dtsg, 0x04030201, 2500)); // 10000 bytes
+  assert(dtsg_app_zs(asp->dtsg, 9998));
+  assert(dtsg_app_b(asp->dtsg, 'z'));
+  assert(dtsg_get_bytes(asp->dtsg) == NULL); // still runs
+
+  assert(output_binary(asp) == ERR_NO_ERROR);
+  assert(read_file(target, buf, sizeof(buf)) == sizeof(buf));
+  assert(buf[8] == 0x20 && buf[9] == 0x4E); // data size 20000
+  assert(buf[KMX_HEADER_SIZE] == 'a');
+  for (i = 0; i < 10000; i++) {
+    assert(buf[KMX_HEADER_SIZE + 1 + i] == (uint8_t)(1 + i % 4));
+  }
+  for (i = 10001; i < 19999; i++) {
+    assert(buf[KMX_HEADER_SIZE + i] == 0);
+  }
+  assert(buf[KMX_HEADER_SIZE + 19999] == 'z');
+
+  asp_free(&asp);
+  remove(target);
+}
+
+TEST(bss_is_not_written) {
+  /* Trailing BSS is only counted in the header, its bytes aren't in file */
+  char target[] = "out_bss.kmx";
+  struct Config config = {0};
+  struct Assembler_Processing *asp = NULL;
+  uint8_t buf[64];
+
+  config.target = target;
+  asp = asp_create(&config, NULL, NULL, NULL);
+  assert(asp != NULL);
+  assert(dtsg_app_b(asp->dtsg, 'x'));
+  assert(dtsg_app_zs(asp->dtsg, 70000));
+  asp->bss_size = 70000;
+
+  assert(output_binary(asp) == ERR_NO_ERROR);
+  assert(read_file(target, buf, sizeof(buf)) == KMX_HEADER_SIZE + 1);
+  assert(buf[8] == 1 && buf[9] == 0 && buf[10] == 0);
+  assert(buf[12] == 0x70 && buf[13] == 0x11 && buf[14] == 0x01); // 70000
+  assert(buf[KMX_HEADER_SIZE] == 'x');
+
+  /* BSS can't be larger than the data segment */
+  asp->bss_size = 70002;
+  assert(output_binary(asp) != ERR_NO_ERROR);
+
+  asp_free(&asp);
+  remove(target);
+}
+
+TEST(unwritable_target_fails) {
+  /* Directory which doesn't exist can't hold the temporary file */
+  char target[] = "no_such_dir/out.kmx";
+  struct Config config = {0};
+  struct Assembler_Processing *asp = NULL;
+
+  config.target = target;
+  asp = asp_create(&config, NULL, NULL, NULL);
+  assert(asp != NULL);
+
+  assert(output_binary(asp) != ERR_NO_ERROR);
+
+  asp_free(&asp);
+}
+
+int main(void) {
+  printf("========================================\n");
+  printf("Running Output Test Suite\n");
+  printf("========================================\n\n");
+
+  RUN_TEST(writes_header_and_segments);
+  RUN_TEST(replaces_existing_target);
+  RUN_TEST(streams_data_runs);
+  RUN_TEST(bss_is_not_written);
+  RUN_TEST(unwritable_target_fails);
+
+  printf("\n========================================\n");
+  printf("All tests passed!\n");
+  printf("========================================\n");
+
+  assert(jemory() == 0);
+  return 0;
+}
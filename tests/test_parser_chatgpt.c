@@ -36,14 +36,7 @@ static struct Token *make_token(enum Token_Type type, const char *value,
   struct Token *t = malloc(sizeof(*t));
   if (!t)
     return NULL;
-  t->type = type;
-  t->line_number = line;
-  if (value) {
-    strncpy(t->value, value, TOKEN_MAX_VALUE_LEN - 1);
-    t->value[TOKEN_MAX_VALUE_LEN - 1] = '\0';
-  } else {
-    t->value[0] = '\0';
-  }
+  lexer_token_init(t, type, value, value ? strlen(value) : 0, line);
   return t;
 }
 
@@ -54,19 +47,17 @@ static void free_token_array(struct Token *arr[], size_t count) {
   }
 }
 
-// Build NULL-terminated token pointer array (last must be EOF token).
+// Build contiguous token array (last must be EOF token), as the lexer makes.
 // Returns number of tokens (including EOF) via out_count. Returned array is
-// malloc'd and must be freed by caller (free()) but tokens themselves must be
-// freed separately.
-static struct Token **build_token_ptr_array(struct Token *tokens[], size_t n,
-                                            size_t *out_count) {
-  // make array of pointers sized n+1 (for EOF) and final NULL sentinel not
-  // required by APIs, but we keep explicit EOF token as last element.
-  struct Token **arr = malloc((n + 1) * sizeof(struct Token *));
+// malloc'd copy and must be freed by caller (free()) but tokens themselves must
+// be freed separately.
+static struct Token *build_token_array(struct Token *tokens[], size_t n,
+                                       size_t *out_count) {
+  struct Token *arr = malloc(n * sizeof(struct Token));
   if (!arr)
     return NULL;
   for (size_t i = 0; i < n; ++i)
-    arr[i] = tokens[i];
+    arr[i] = *tokens[i];
   // caller should ensure tokens[n-1] is EOF if they intended so; we don't
   // insert extra EOF here.
   *out_count = n;
@@ -169,24 +160,24 @@ static int test_grammar_kma(void) {
 
   struct Token *tokens[] = {t1, t2};
   size_t tn;
-  struct Token **parr = build_token_ptr_array(tokens, 2, &tn);
-  if (!parr) {
+  struct Token *tarr = build_token_array(tokens, 2, &tn);
+  if (!tarr) {
     free_token_array(tokens, 2);
     return 0;
   }
 
   struct Parsed_Statement *pstmt = p_stmt_create(STMT_NONE, 1);
   if (!pstmt) {
-    free(parr);
+    free(tarr);
     free_token_array(tokens, 2);
     return 0;
   }
 
-  enum Err_Grm res = grammar_line_kma(pstmt, (const struct Token **)parr);
+  enum Err_Grm res = grammar_line_kma(pstmt, tarr);
   int ok = (res == GRM_MATCH) && (pstmt->type == STMT_KMA);
 
   p_stmt_free(&pstmt);
-  free(parr);
+  free(tarr);
   free_token_array(tokens, 2);
   return ok;
 }
@@ -204,24 +195,24 @@ static int test_grammar_code(void) {
 
   struct Token *tokens[] = {t1, t2};
   size_t tn;
-  struct Token **parr = build_token_ptr_array(tokens, 2, &tn);
-  if (!parr) {
+  struct Token *tarr = build_token_array(tokens, 2, &tn);
+  if (!tarr) {
     free_token_array(tokens, 2);
     return 0;
   }
 
   struct Parsed_Statement *pstmt = p_stmt_create(STMT_NONE, 2);
   if (!pstmt) {
-    free(parr);
+    free(tarr);
     free_token_array(tokens, 2);
     return 0;
   }
 
-  enum Err_Grm res = grammar_line_code(pstmt, (const struct Token **)parr);
+  enum Err_Grm res = grammar_line_code(pstmt, tarr);
   int ok = (res == GRM_MATCH) && (pstmt->type == STMT_SECTION_CODE);
 
   p_stmt_free(&pstmt);
-  free(parr);
+  free(tarr);
   free_token_array(tokens, 2);
   return ok;
 }
@@ -239,24 +230,24 @@ static int test_grammar_data(void) {
 
   struct Token *tokens[] = {t1, t2};
   size_t tn;
-  struct Token **parr = build_token_ptr_array(tokens, 2, &tn);
-  if (!parr) {
+  struct Token *tarr = build_token_array(tokens, 2, &tn);
+  if (!tarr) {
     free_token_array(tokens, 2);
     return 0;
   }
 
   struct Parsed_Statement *pstmt = p_stmt_create(STMT_NONE, 3);
   if (!pstmt) {
-    free(parr);
+    free(tarr);
     free_token_array(tokens, 2);
     return 0;
   }
 
-  enum Err_Grm res = grammar_line_data(pstmt, (const struct Token **)parr);
+  enum Err_Grm res = grammar_line_data(pstmt, tarr);
   int ok = (res == GRM_MATCH) && (pstmt->type == STMT_SECTION_DATA);
 
   p_stmt_free(&pstmt);
-  free(parr);
+  free(tarr);
   free_token_array(tokens, 2);
   return ok;
 }
@@ -271,38 +262,32 @@ static int test_grammar_label(void) {
     free(t2);
     return 0;
   }
+  t1->id = 7; // symbol id, as if interned by lexer
 
   struct Token *tokens[] = {t1, t2};
   size_t tn;
-  struct Token **parr = build_token_ptr_array(tokens, 2, &tn);
-  if (!parr) {
+  struct Token *tarr = build_token_array(tokens, 2, &tn);
+  if (!tarr) {
     free_token_array(tokens, 2);
     return 0;
   }
 
   struct Parsed_Statement *pstmt = p_stmt_create(STMT_NONE, 4);
   if (!pstmt) {
-    free(parr);
+    free(tarr);
     free_token_array(tokens, 2);
     return 0;
   }
 
-  enum Err_Grm res = grammar_line_label(pstmt, (const struct Token **)parr);
+  enum Err_Grm res = grammar_line_label(pstmt, tarr);
   int ok = (res == GRM_MATCH) && (pstmt->type == STMT_LABEL_DEF);
 
-  // additionally, if label name present, check it copied
-  if (ok) {
-    if (strlen(pstmt->content.label_def.label_name) == 0)
-      ok = 0;
-    else {
-      // label name in header _includes_ @; check substring
-      if (strstr(pstmt->content.label_def.label_name, "L1") == NULL)
-        ok = 0;
-    }
-  }
+  // additionally, check the label keeps the symbol id of its name
+  if (ok && pstmt->content.label_def.label_id != 7)
+    ok = 0;
 
   p_stmt_free(&pstmt);
-  free(parr);
+  free(tarr);
   free_token_array(tokens, 2);
   return ok;
 }
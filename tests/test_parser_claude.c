@@ -12,10 +12,7 @@
 struct Token *create_token(enum Token_Type type, const char *value,
                            size_t line) {
   struct Token *tok = jalloc(sizeof(struct Token));
-  tok->type = type;
-  strncpy(tok->value, value, TOKEN_MAX_VALUE_LEN - 1);
-  tok->value[TOKEN_MAX_VALUE_LEN - 1] = '\0';
-  tok->line_number = line;
+  lexer_token_init(tok, type, value, strlen(value), line);
   return tok;
 }
 
@@ -134,7 +131,7 @@ void test_parse_tokens_empty_line() {
   struct Token *tokens[1];
   tokens[0] = create_token(TOKEN_EOF, "", 1);
 
-  const struct Token *const_tokens[1] = {tokens[0]};
+  const struct Token const_tokens[1] = {*tokens[0]};
   struct Parsed_Statement *stmt = parse_tokens(const_tokens, 1);
 
   assert(stmt != NULL);
@@ -155,7 +152,7 @@ void test_parse_tokens_kma() {
   tokens[0] = create_token(TOKEN_KMA, ".KMA", 1);
   tokens[1] = create_token(TOKEN_EOF, "", 1);
 
-  const struct Token *const_tokens[2] = {tokens[0], tokens[1]};
+  const struct Token const_tokens[2] = {*tokens[0], *tokens[1]};
   struct Parsed_Statement *stmt = parse_tokens(const_tokens, 1);
 
   assert(stmt != NULL);
@@ -176,7 +173,7 @@ void test_parse_tokens_section_data() {
   tokens[0] = create_token(TOKEN_SECTION_DATA, ".DATA", 5);
   tokens[1] = create_token(TOKEN_EOF, "", 5);
 
-  const struct Token *const_tokens[2] = {tokens[0], tokens[1]};
+  const struct Token const_tokens[2] = {*tokens[0], *tokens[1]};
   struct Parsed_Statement *stmt = parse_tokens(const_tokens, 5);
 
   assert(stmt != NULL);
@@ -197,7 +194,7 @@ void test_parse_tokens_section_code() {
   tokens[0] = create_token(TOKEN_SECTION_CODE, ".CODE", 10);
   tokens[1] = create_token(TOKEN_EOF, "", 10);
 
-  const struct Token *const_tokens[2] = {tokens[0], tokens[1]};
+  const struct Token const_tokens[2] = {*tokens[0], *tokens[1]};
   struct Parsed_Statement *stmt = parse_tokens(const_tokens, 10);
 
   assert(stmt != NULL);
@@ -216,15 +213,16 @@ void test_parse_tokens_label() {
 
   struct Token *tokens[2];
   tokens[0] = create_token(TOKEN_LABEL, "@start", 15);
+  tokens[0]->id = 3; // as if interned by lexer
   tokens[1] = create_token(TOKEN_EOF, "", 15);
 
-  const struct Token *const_tokens[2] = {tokens[0], tokens[1]};
+  const struct Token const_tokens[2] = {*tokens[0], *tokens[1]};
   struct Parsed_Statement *stmt = parse_tokens(const_tokens, 15);
 
   assert(stmt != NULL);
   assert(stmt->type == STMT_LABEL_DEF);
   assert(stmt->line_number == 15);
-  assert(strcmp(stmt->content.label_def.label_name, "@start") == 0);
+  assert(stmt->content.label_def.label_id == 3);
 
   p_stmt_free(&stmt);
   free_token_array(tokens, 2);
@@ -239,18 +237,19 @@ void test_parse_tokens_data_decl_simple() {
   // var1 DWORD 42
   struct Token *tokens[4];
   tokens[0] = create_token(TOKEN_IDENTIFIER, "var1", 20);
+  tokens[0]->id = 4; // as if interned by lexer
   tokens[1] = create_token(TOKEN_DATA_TYPE, "DWORD", 20);
   tokens[2] = create_token(TOKEN_NUMBER, "42", 20);
   tokens[3] = create_token(TOKEN_EOF, "", 20);
 
-  const struct Token *const_tokens[4] = {tokens[0], tokens[1], tokens[2],
-                                         tokens[3]};
+  const struct Token const_tokens[4] = {*tokens[0], *tokens[1], *tokens[2],
+                                         *tokens[3]};
   struct Parsed_Statement *stmt = parse_tokens(const_tokens, 20);
 
   assert(stmt != NULL);
   assert(stmt->type == STMT_DATA_DECL);
   assert(stmt->line_number == 20);
-  assert(strcmp(stmt->content.data_decl.identifier, "var1") == 0);
+  assert(stmt->content.data_decl.identifier_id == 4);
   assert(stmt->content.data_decl.type == DATA_DWORD);
   assert(stmt->content.data_decl.segment_count == 1);
   assert(stmt->content.data_decl.segments[0].type == INIT_SEG_VALUE);
@@ -270,12 +269,13 @@ void test_parse_tokens_data_decl_uninit() {
   // var2 DWORD ?
   struct Token *tokens[4];
   tokens[0] = create_token(TOKEN_IDENTIFIER, "var2", 25);
+  tokens[0]->id = 7; // as if interned by lexer
   tokens[1] = create_token(TOKEN_DATA_TYPE, "DWORD", 25);
   tokens[2] = create_token(TOKEN_QUESTION, "?", 25);
   tokens[3] = create_token(TOKEN_EOF, "", 25);
 
-  const struct Token *const_tokens[4] = {tokens[0], tokens[1], tokens[2],
-                                         tokens[3]};
+  const struct Token const_tokens[4] = {*tokens[0], *tokens[1], *tokens[2],
+                                         *tokens[3]};
   struct Parsed_Statement *stmt = parse_tokens(const_tokens, 25);
 
   assert(stmt != NULL);
@@ -296,6 +296,7 @@ void test_parse_tokens_data_decl_dup() {
   // array DWORD 10 DUP(0)
   struct Token *tokens[8];
   tokens[0] = create_token(TOKEN_IDENTIFIER, "array", 30);
+  tokens[0]->id = 8; // as if interned by lexer
   tokens[1] = create_token(TOKEN_DATA_TYPE, "DWORD", 30);
   tokens[2] = create_token(TOKEN_NUMBER, "10", 30);
   tokens[3] = create_token(TOKEN_DUP, "DUP", 30);
@@ -304,9 +305,9 @@ void test_parse_tokens_data_decl_dup() {
   tokens[6] = create_token(TOKEN_RPAREN, ")", 30);
   tokens[7] = create_token(TOKEN_EOF, "", 30);
 
-  const struct Token *const_tokens[8] = {tokens[0], tokens[1], tokens[2],
-                                         tokens[3], tokens[4], tokens[5],
-                                         tokens[6], tokens[7]};
+  const struct Token const_tokens[8] = {*tokens[0], *tokens[1], *tokens[2],
+                                         *tokens[3], *tokens[4], *tokens[5],
+                                         *tokens[6], *tokens[7]};
   struct Parsed_Statement *stmt = parse_tokens(const_tokens, 30);
 
   assert(stmt != NULL);
@@ -329,6 +330,7 @@ void test_parse_tokens_data_decl_multiple() {
   // values DWORD 1, 2, 3
   struct Token *tokens[8];
   tokens[0] = create_token(TOKEN_IDENTIFIER, "values", 35);
+  tokens[0]->id = 9; // as if interned by lexer
   tokens[1] = create_token(TOKEN_DATA_TYPE, "DWORD", 35);
   tokens[2] = create_token(TOKEN_NUMBER, "1", 35);
   tokens[3] = create_token(TOKEN_COMMA, ",", 35);
@@ -337,9 +339,9 @@ void test_parse_tokens_data_decl_multiple() {
   tokens[6] = create_token(TOKEN_NUMBER, "3", 35);
   tokens[7] = create_token(TOKEN_EOF, "", 35);
 
-  const struct Token *const_tokens[8] = {tokens[0], tokens[1], tokens[2],
-                                         tokens[3], tokens[4], tokens[5],
-                                         tokens[6], tokens[7]};
+  const struct Token const_tokens[8] = {*tokens[0], *tokens[1], *tokens[2],
+                                         *tokens[3], *tokens[4], *tokens[5],
+                                         *tokens[6], *tokens[7]};
   struct Parsed_Statement *stmt = parse_tokens(const_tokens, 35);
 
   assert(stmt != NULL);
@@ -362,19 +364,22 @@ void test_parse_tokens_data_decl_string() {
   // msg BYTE "Hello"
   struct Token *tokens[4];
   tokens[0] = create_token(TOKEN_IDENTIFIER, "msg", 40);
+  tokens[0]->id = 10; // as if interned by lexer
   tokens[1] = create_token(TOKEN_DATA_TYPE, "BYTE", 40);
   tokens[2] = create_token(TOKEN_STRING, "Hello", 40);
   tokens[3] = create_token(TOKEN_EOF, "", 40);
 
-  const struct Token *const_tokens[4] = {tokens[0], tokens[1], tokens[2],
-                                         tokens[3]};
+  const struct Token const_tokens[4] = {*tokens[0], *tokens[1], *tokens[2],
+                                         *tokens[3]};
   struct Parsed_Statement *stmt = parse_tokens(const_tokens, 40);
 
   assert(stmt != NULL);
   assert(stmt->type == STMT_DATA_DECL);
   assert(stmt->content.data_decl.type == DATA_BYTE);
   assert(stmt->content.data_decl.segments[0].type == INIT_SEG_STRING);
-  assert(strcmp(stmt->content.data_decl.segments[0].data.string, "Hello") == 0);
+  assert(stmt->content.data_decl.segments[0].data.string.len == 5);
+  assert(memcmp(stmt->content.data_decl.segments[0].data.string.text, "Hello",
+                5) == 0);
 
   p_stmt_free(&stmt);
   free_token_array(tokens, 4);
@@ -391,7 +396,7 @@ void test_parse_tokens_instruction_no_operands() {
   tokens[0] = create_token(TOKEN_INSTRUCTION, "RET", 50);
   tokens[1] = create_token(TOKEN_EOF, "", 50);
 
-  const struct Token *const_tokens[2] = {tokens[0], tokens[1]};
+  const struct Token const_tokens[2] = {*tokens[0], *tokens[1]};
   struct Parsed_Statement *stmt = parse_tokens(const_tokens, 50);
 
   assert(stmt != NULL);
@@ -414,14 +419,13 @@ void test_parse_tokens_instruction_one_register() {
   tokens[1] = create_token(TOKEN_REGISTER, "A", 55);
   tokens[2] = create_token(TOKEN_EOF, "", 55);
 
-  const struct Token *const_tokens[3] = {tokens[0], tokens[1], tokens[2]};
+  const struct Token const_tokens[3] = {*tokens[0], *tokens[1], *tokens[2]};
   struct Parsed_Statement *stmt = parse_tokens(const_tokens, 55);
 
   assert(stmt != NULL);
   assert(stmt->type == STMT_INSTRUCTION);
   assert(stmt->content.instruction.operand_count == 1);
-  assert(strcmp(stmt->content.instruction.operands[0].value.register_name,
-                "A") == 0);
+  assert(stmt->content.instruction.operands[0].value.reg == REG_A);
 
   p_stmt_free(&stmt);
   free_token_array(tokens, 3);
@@ -441,8 +445,8 @@ void test_parse_tokens_instruction_two_registers() {
   tokens[3] = create_token(TOKEN_REGISTER, "B", 60);
   tokens[4] = create_token(TOKEN_EOF, "", 60);
 
-  const struct Token *const_tokens[5] = {tokens[0], tokens[1], tokens[2],
-                                         tokens[3], tokens[4]};
+  const struct Token const_tokens[5] = {*tokens[0], *tokens[1], *tokens[2],
+                                         *tokens[3], *tokens[4]};
   struct Parsed_Statement *stmt = parse_tokens(const_tokens, 60);
 
   assert(stmt != NULL);
@@ -450,10 +454,8 @@ void test_parse_tokens_instruction_two_registers() {
   printf("op_count %i", stmt->content.instruction.operand_count);
   fflush(stdout);
   assert(stmt->content.instruction.operand_count == 2);
-  assert(strcmp(stmt->content.instruction.operands[0].value.register_name,
-                "A") == 0);
-  assert(strcmp(stmt->content.instruction.operands[1].value.register_name,
-                "B") == 0);
+  assert(stmt->content.instruction.operands[0].value.reg == REG_A);
+  assert(stmt->content.instruction.operands[1].value.reg == REG_B);
 
   p_stmt_free(&stmt);
   free_token_array(tokens, 5);
@@ -473,8 +475,8 @@ void test_parse_tokens_instruction_reg_immediate() {
   tokens[3] = create_token(TOKEN_NUMBER, "100", 65);
   tokens[4] = create_token(TOKEN_EOF, "", 65);
 
-  const struct Token *const_tokens[5] = {tokens[0], tokens[1], tokens[2],
-                                         tokens[3], tokens[4]};
+  const struct Token const_tokens[5] = {*tokens[0], *tokens[1], *tokens[2],
+                                         *tokens[3], *tokens[4]};
   struct Parsed_Statement *stmt = parse_tokens(const_tokens, 65);
 
   assert(stmt != NULL);
@@ -499,18 +501,18 @@ void test_parse_tokens_instruction_offset() {
   tokens[2] = create_token(TOKEN_COMMA, ",", 70);
   tokens[3] = create_token(TOKEN_OFFSET, "OFFSET", 70);
   tokens[4] = create_token(TOKEN_IDENTIFIER, "myvar", 70);
+  tokens[4]->id = 5; // as if interned by lexer
   tokens[5] = create_token(TOKEN_EOF, "", 70);
 
-  const struct Token *const_tokens[6] = {tokens[0], tokens[1], tokens[2],
-                                         tokens[3], tokens[4], tokens[5]};
+  const struct Token const_tokens[6] = {*tokens[0], *tokens[1], *tokens[2],
+                                         *tokens[3], *tokens[4], *tokens[5]};
   struct Parsed_Statement *stmt = parse_tokens(const_tokens, 70);
 
   assert(stmt != NULL);
   assert(stmt->type == STMT_INSTRUCTION);
   assert(stmt->content.instruction.operand_count == 2);
   assert(stmt->content.instruction.operands[1].specifier == OPS_OFFSET);
-  assert(strcmp(stmt->content.instruction.operands[1].value.label, "myvar") ==
-         0);
+  assert(stmt->content.instruction.operands[1].value.symbol_id == 5);
 
   p_stmt_free(&stmt);
   free_token_array(tokens, 6);
@@ -526,17 +528,17 @@ void test_parse_tokens_instruction_label() {
   struct Token *tokens[3];
   tokens[0] = create_token(TOKEN_INSTRUCTION, "JMP", 75);
   tokens[1] = create_token(TOKEN_LABEL, "@loop", 75);
+  tokens[1]->id = 6; // as if interned by lexer
   tokens[2] = create_token(TOKEN_EOF, "", 75);
 
-  const struct Token *const_tokens[3] = {tokens[0], tokens[1], tokens[2]};
+  const struct Token const_tokens[3] = {*tokens[0], *tokens[1], *tokens[2]};
   struct Parsed_Statement *stmt = parse_tokens(const_tokens, 75);
 
   assert(stmt != NULL);
   assert(stmt->type == STMT_INSTRUCTION);
   assert(stmt->content.instruction.operand_count == 1);
   assert(stmt->content.instruction.operands[0].specifier == OPS_LABEL);
-  assert(strcmp(stmt->content.instruction.operands[0].value.label, "@loop") ==
-         0);
+  assert(stmt->content.instruction.operands[0].value.symbol_id == 6);
 
   p_stmt_free(&stmt);
   free_token_array(tokens, 3);
@@ -565,7 +567,7 @@ void test_parse_tokens_error_handling() {
   tokens[1] = create_token(TOKEN_COMMA, ",", 80);
   tokens[2] = create_token(TOKEN_EOF, "", 80);
 
-  const struct Token *const_tokens[3] = {tokens[0], tokens[1], tokens[2]};
+  const struct Token const_tokens[3] = {*tokens[0], *tokens[1], *tokens[2]};
   struct Parsed_Statement *stmt = parse_tokens(const_tokens, 80);
 
   // Should either return NULL or return statement with ERROR type
@@ -579,6 +581,139 @@ void test_parse_tokens_error_handling() {
   printf("  PASSED\n");
 }
 
+// Test: parse_tokens must not read past EOF of unfinished DUP
+void test_parse_tokens_data_decl_dup_truncated() {
+  printf("Running test_parse_tokens_data_decl_dup_truncated...\n");
+
+  // array DWORD 10 DUP(  -- array is exactly as long as the tokens
+  struct Token *tokens[6];
+  tokens[0] = create_token(TOKEN_IDENTIFIER, "array", 85);
+  tokens[1] = create_token(TOKEN_DATA_TYPE, "DWORD", 85);
+  tokens[2] = create_token(TOKEN_NUMBER, "10", 85);
+  tokens[3] = create_token(TOKEN_DUP, "DUP", 85);
+  tokens[4] = create_token(TOKEN_LPAREN, "(", 85);
+  tokens[5] = create_token(TOKEN_EOF, "", 85);
+
+  struct Token *const_tokens = jalloc(6 * sizeof(struct Token));
+  assert(const_tokens != NULL);
+  for (size_t i = 0; i < 6; i++) {
+    const_tokens[i] = *tokens[i];
+  }
+  struct Parsed_Statement *stmt = parse_tokens(const_tokens, 85);
+
+  // Unmatched line gives NULL, ASan catches any read past the array
+  assert(stmt == NULL);
+
+  jree(const_tokens);
+  free_token_array(tokens, 6);
+
+  printf("  PASSED\n");
+}
+
+// Test: parse_tokens with very long list keeps every element in order
+void test_parse_tokens_data_decl_long_list() {
+  printf("Running test_parse_tokens_data_decl_long_list...\n");
+
+  // big DWORD 0, 1, 2, ..., ?  -- deep enough to overflow recursive parser
+  const size_t count = 100000;
+  const size_t ntok = 2 + 2 * count; // name, type, (elem, comma/EOF) * count
+  static char digits[100000][8];
+  struct Token *toks = jalloc(ntok * sizeof(struct Token));
+  assert(toks != NULL);
+
+  lexer_token_init(&toks[0], TOKEN_IDENTIFIER, "big", 3, 90);
+  toks[0].id = 11; // as if interned by lexer
+  lexer_token_init(&toks[1], TOKEN_DATA_TYPE, "DWORD", 5, 90);
+  for (size_t i = 0; i < count; i++) {
+    struct Token *elem = &toks[2 + 2 * i];
+    if (i == count - 1) {
+      lexer_token_init(elem, TOKEN_QUESTION, "?", 1, 90);
+    } else {
+      int len = snprintf(digits[i], sizeof(digits[i]), "%zu", i);
+      lexer_token_init(elem, TOKEN_NUMBER, digits[i], (size_t)len, 90);
+    }
+    if (i == count - 1) {
+      lexer_token_init(elem + 1, TOKEN_EOF, "", 0, 90);
+    } else {
+      lexer_token_init(elem + 1, TOKEN_COMMA, ",", 1, 90);
+    }
+  }
+
+  struct Parsed_Statement *stmt = parse_tokens(toks, 90);
+
+  assert(stmt != NULL);
+  assert(stmt->type == STMT_DATA_DECL);
+  assert(stmt->content.data_decl.segment_count == count);
+  assert(stmt->content.data_decl.segments[0].data.value == 0);
+  assert(stmt->content.data_decl.segments[12345].data.value == 12345);
+  assert(stmt->content.data_decl.segments[count - 1].is_uninit == 1);
+  assert(stmt->content.data_decl.is_fully_uninit == 0);
+  assert(stmt->content.data_decl.total_size == count * 4);
+
+  p_stmt_free(&stmt);
+  jree(toks);
+
+  printf("  PASSED\n");
+}
+
+// Test: lexer & parser allocate a whole line from arena, reset releases it
+void test_parse_tokens_arena() {
+  printf("Running test_parse_tokens_arena...\n");
+
+  const char *line = "nums DWORD 1, 2 DUP(?), 3, 4, 5, 6, 7, 8, 9";
+  struct Jarena arena;
+  struct Jarena_Mark mark;
+  struct Symbol_Table *symtab = symtab_create();
+  assert(symtab != NULL);
+  assert(jarena_init(&arena, 0));
+  jarena_mark(&arena, &mark);
+
+  size_t before = jemory();
+  for (int i = 0; i < 3; i++) {
+    struct Token *tokens =
+        lexer_tokenize_arena(&arena, line, strlen(line), 5, symtab);
+    assert(tokens != NULL);
+    struct Parsed_Statement *stmt = parse_tokens_arena(&arena, tokens, 5);
+
+    assert(stmt != NULL);
+    assert(stmt->arena == &arena);
+    assert(stmt->type == STMT_DATA_DECL);
+    assert(stmt->content.data_decl.segment_count == 9);
+    assert(stmt->content.data_decl.segments[1].type == INIT_SEG_DUP);
+    assert(stmt->content.data_decl.total_size == 10 * 4);
+
+    p_stmt_free(&stmt); // only deinited, the arena owns the memory
+    jarena_reset(&arena, &mark);
+    assert(jemory() == before + 1); // the one block is reused every line
+  }
+
+  jarena_deinit(&arena);
+  assert(jemory() == before);
+  symtab_free(&symtab);
+
+  printf("  PASSED\n");
+}
+
+// Test: names lexed without symtab have no symbol id, parsing them must fail
+void test_parse_tokens_not_interned() {
+  printf("Running test_parse_tokens_not_interned...\n");
+
+  const char *lines[] = {"@start", "x DWORD 1", "JMP @start",
+                         "MOV A, OFFSET x"};
+  for (size_t i = 0; i < sizeof(lines) / sizeof(lines[0]); i++) {
+    struct Token *tokens = lexer_tokenize_line(lines[i], 90);
+    assert(tokens != NULL);
+    struct Parsed_Statement *stmt = parse_tokens(tokens, 90);
+
+    // never silently mapped to symbol 0
+    assert(stmt == NULL || stmt->err != PAR_NO_ERROR);
+    p_stmt_free(&stmt);
+    lexer_free_tokens(tokens);
+  }
+
+  printf("  PASSED\n");
+}
+
 int main(void) {
   printf("=== Running Parser Tests ===\n\n");
 
@@ -603,6 +738,10 @@ int main(void) {
   test_parse_tokens_instruction_label();
   test_parse_tokens_invalid_null();
   test_parse_tokens_error_handling();
+  test_parse_tokens_data_decl_dup_truncated();
+  test_parse_tokens_data_decl_long_list();
+  test_parse_tokens_arena();
+  test_parse_tokens_not_interned();
 
   printf("\n=== All Parser Tests Passed! ===\n");
   return 0;
@@ -11,10 +11,7 @@
 struct Token *create_test_token(enum Token_Type type, const char *value,
                                 size_t line) {
   struct Token *tok = jalloc(sizeof(struct Token));
-  tok->type = type;
-  strncpy(tok->value, value, TOKEN_MAX_VALUE_LEN - 1);
-  tok->value[TOKEN_MAX_VALUE_LEN - 1] = '\0';
-  tok->line_number = line;
+  lexer_token_init(tok, type, value, strlen(value), line);
   return tok;
 }
 
@@ -32,7 +29,7 @@ void test_grammar_line_empty() {
   struct Token *tokens[1];
   tokens[0] = create_test_token(TOKEN_EOF, "", 1);
 
-  const struct Token *const_tokens[1] = {tokens[0]};
+  const struct Token const_tokens[1] = {*tokens[0]};
 
   struct Parsed_Statement stmt;
   p_stmt_init(&stmt, STMT_NONE, 1);
@@ -56,7 +53,7 @@ void test_grammar_line_kma_match() {
   tokens[0] = create_test_token(TOKEN_KMA, ".KMA", 1);
   tokens[1] = create_test_token(TOKEN_EOF, "", 1);
 
-  const struct Token *const_tokens[2] = {tokens[0], tokens[1]};
+  const struct Token const_tokens[2] = {*tokens[0], *tokens[1]};
 
   struct Parsed_Statement stmt;
   p_stmt_init(&stmt, STMT_NONE, 1);
@@ -80,7 +77,7 @@ void test_grammar_line_kma_no_match() {
   tokens[0] = create_test_token(TOKEN_SECTION_DATA, ".DATA", 1);
   tokens[1] = create_test_token(TOKEN_EOF, "", 1);
 
-  const struct Token *const_tokens[2] = {tokens[0], tokens[1]};
+  const struct Token const_tokens[2] = {*tokens[0], *tokens[1]};
 
   struct Parsed_Statement stmt;
   enum Statement_Type original_type = STMT_NONE;
@@ -106,7 +103,7 @@ void test_grammar_line_code_match() {
   tokens[0] = create_test_token(TOKEN_SECTION_CODE, ".CODE", 5);
   tokens[1] = create_test_token(TOKEN_EOF, "", 5);
 
-  const struct Token *const_tokens[2] = {tokens[0], tokens[1]};
+  const struct Token const_tokens[2] = {*tokens[0], *tokens[1]};
 
   struct Parsed_Statement stmt;
   p_stmt_init(&stmt, STMT_NONE, 5);
@@ -130,7 +127,7 @@ void test_grammar_line_code_no_match() {
   tokens[0] = create_test_token(TOKEN_KMA, ".KMA", 5);
   tokens[1] = create_test_token(TOKEN_EOF, "", 5);
 
-  const struct Token *const_tokens[2] = {tokens[0], tokens[1]};
+  const struct Token const_tokens[2] = {*tokens[0], *tokens[1]};
 
   struct Parsed_Statement stmt;
   p_stmt_init(&stmt, STMT_NONE, 5);
@@ -153,7 +150,7 @@ void test_grammar_line_data_match() {
   tokens[0] = create_test_token(TOKEN_SECTION_DATA, ".DATA", 10);
   tokens[1] = create_test_token(TOKEN_EOF, "", 10);
 
-  const struct Token *const_tokens[2] = {tokens[0], tokens[1]};
+  const struct Token const_tokens[2] = {*tokens[0], *tokens[1]};
 
   struct Parsed_Statement stmt;
   p_stmt_init(&stmt, STMT_NONE, 10);
@@ -175,9 +172,10 @@ void test_grammar_line_label_match() {
 
   struct Token *tokens[2];
   tokens[0] = create_test_token(TOKEN_LABEL, "@start", 15);
+  tokens[0]->id = 3; // as if interned by lexer
   tokens[1] = create_test_token(TOKEN_EOF, "", 15);
 
-  const struct Token *const_tokens[2] = {tokens[0], tokens[1]};
+  const struct Token const_tokens[2] = {*tokens[0], *tokens[1]};
 
   struct Parsed_Statement stmt;
   p_stmt_init(&stmt, STMT_LABEL_DEF, 15);
@@ -186,7 +184,7 @@ void test_grammar_line_label_match() {
 
   assert(result == GRM_MATCH);
   assert(stmt.type == STMT_LABEL_DEF);
-  assert(strcmp(stmt.content.label_def.label_name, "@start") == 0);
+  assert(stmt.content.label_def.label_id == 3);
 
   p_stmt_deinit(&stmt);
   cleanup_tokens(tokens, 2);
@@ -194,6 +192,41 @@ void test_grammar_line_label_match() {
   printf("  PASSED\n");
 }
 
+// Test: label and identifier not interned by lexer fail, pstmt is unchanged
+void test_grammar_line_not_interned() {
+  printf("Running test_grammar_line_not_interned...\n");
+
+  struct Token *tokens[4];
+  tokens[0] = create_test_token(TOKEN_LABEL, "@start", 16);
+  tokens[1] = create_test_token(TOKEN_EOF, "", 16);
+  assert(tokens[0]->id == TOKEN_NO_ID);
+
+  const struct Token label_tokens[2] = {*tokens[0], *tokens[1]};
+  struct Parsed_Statement stmt;
+  memset(&stmt, 0, sizeof(stmt)); // STMT_NONE leaves content as it is
+  p_stmt_init(&stmt, STMT_NONE, 16);
+
+  assert(grammar_line_label(&stmt, label_tokens) == GRM_GENERIC_ERROR);
+  assert(stmt.type == STMT_NONE && stmt.content.label_def.label_id == 0);
+  cleanup_tokens(tokens, 2);
+
+  tokens[0] = create_test_token(TOKEN_IDENTIFIER, "var", 16);
+  tokens[1] = create_test_token(TOKEN_DATA_TYPE, "DW", 16);
+  tokens[2] = create_test_token(TOKEN_NUMBER, "1", 16);
+  tokens[3] = create_test_token(TOKEN_EOF, "", 16);
+  const struct Token decl_tokens[4] = {*tokens[0], *tokens[1], *tokens[2],
+                                       *tokens[3]};
+
+  assert(grammar_line_identifier(&stmt, decl_tokens) == GRM_GENERIC_ERROR);
+  assert(stmt.type == STMT_NONE);
+  assert(stmt.content.data_decl.segment_count == 0);
+
+  p_stmt_deinit(&stmt);
+  cleanup_tokens(tokens, 4);
+
+  printf("  PASSED\n");
+}
+
 // Test: grammar_line_label should handle different label names
 void test_grammar_line_label_various_names() {
   printf("Running test_grammar_line_label_various_names...\n");
@@ -203,9 +236,10 @@ void test_grammar_line_label_various_names() {
   for (int i = 0; i < 4; i++) {
     struct Token *tokens[2];
     tokens[0] = create_test_token(TOKEN_LABEL, label_names[i], 20);
+    tokens[0]->id = i;
     tokens[1] = create_test_token(TOKEN_EOF, "", 20);
 
-    const struct Token *const_tokens[2] = {tokens[0], tokens[1]};
+    const struct Token const_tokens[2] = {*tokens[0], *tokens[1]};
 
     struct Parsed_Statement stmt;
     p_stmt_init(&stmt, STMT_LABEL_DEF, 20);
@@ -213,7 +247,7 @@ void test_grammar_line_label_various_names() {
     enum Err_Grm result = grammar_line_label(&stmt, const_tokens);
 
     assert(result == GRM_MATCH);
-    assert(strcmp(stmt.content.label_def.label_name, label_names[i]) == 0);
+    assert(stmt.content.label_def.label_id == (uint32_t)i);
 
     p_stmt_deinit(&stmt);
     cleanup_tokens(tokens, 2);
@@ -229,12 +263,13 @@ void test_grammar_line_identifier_dword() {
   // var1 DWORD 42
   struct Token *tokens[4];
   tokens[0] = create_test_token(TOKEN_IDENTIFIER, "var1", 25);
+  tokens[0]->id = 4; // as if interned by lexer
   tokens[1] = create_test_token(TOKEN_DATA_TYPE, "DWORD", 25);
   tokens[2] = create_test_token(TOKEN_NUMBER, "42", 25);
   tokens[3] = create_test_token(TOKEN_EOF, "", 25);
 
-  const struct Token *const_tokens[4] = {tokens[0], tokens[1], tokens[2],
-                                         tokens[3]};
+  const struct Token const_tokens[4] = {*tokens[0], *tokens[1], *tokens[2],
+                                         *tokens[3]};
 
   struct Parsed_Statement stmt;
   p_stmt_init(&stmt, STMT_DATA_DECL, 25);
@@ -243,7 +278,7 @@ void test_grammar_line_identifier_dword() {
 
   assert(result == GRM_MATCH);
   assert(stmt.type == STMT_DATA_DECL);
-  assert(strcmp(stmt.content.data_decl.identifier, "var1") == 0);
+  assert(stmt.content.data_decl.identifier_id == 4);
 
   p_stmt_deinit(&stmt);
   cleanup_tokens(tokens, 4);
@@ -258,12 +293,13 @@ void test_grammar_line_identifier_byte() {
   // char1 BYTE 65
   struct Token *tokens[4];
   tokens[0] = create_test_token(TOKEN_IDENTIFIER, "char1", 30);
+  tokens[0]->id = 6; // as if interned by lexer
   tokens[1] = create_test_token(TOKEN_DATA_TYPE, "BYTE", 30);
   tokens[2] = create_test_token(TOKEN_NUMBER, "65", 30);
   tokens[3] = create_test_token(TOKEN_EOF, "", 30);
 
-  const struct Token *const_tokens[4] = {tokens[0], tokens[1], tokens[2],
-                                         tokens[3]};
+  const struct Token const_tokens[4] = {*tokens[0], *tokens[1], *tokens[2],
+                                         *tokens[3]};
 
   struct Parsed_Statement stmt;
   p_stmt_init(&stmt, STMT_DATA_DECL, 30);
@@ -289,7 +325,7 @@ void test_grammar_identifier_dw_dec_single() {
   tokens[0] = create_test_token(TOKEN_NUMBER, "42", 35);
   tokens[1] = create_test_token(TOKEN_EOF, "", 35);
 
-  const struct Token *const_tokens[2] = {tokens[0], tokens[1]};
+  const struct Token const_tokens[2] = {*tokens[0], *tokens[1]};
 
   struct Parsed_Statement stmt;
   p_stmt_init(&stmt, STMT_DATA_DECL, 35);
@@ -315,7 +351,7 @@ void test_grammar_identifier_dw_dec_uninit() {
   tokens[0] = create_test_token(TOKEN_QUESTION, "?", 40);
   tokens[1] = create_test_token(TOKEN_EOF, "", 40);
 
-  const struct Token *const_tokens[2] = {tokens[0], tokens[1]};
+  const struct Token const_tokens[2] = {*tokens[0], *tokens[1]};
 
   struct Parsed_Statement stmt;
   p_stmt_init(&stmt, STMT_DATA_DECL, 40);
@@ -345,8 +381,8 @@ void test_grammar_identifier_dw_dup_with_value() {
   tokens[4] = create_test_token(TOKEN_RPAREN, ")", 45);
   tokens[5] = create_test_token(TOKEN_EOF, "", 45);
 
-  const struct Token *const_tokens[6] = {tokens[0], tokens[1], tokens[2],
-                                         tokens[3], tokens[4], tokens[5]};
+  const struct Token const_tokens[6] = {*tokens[0], *tokens[1], *tokens[2],
+                                         *tokens[3], *tokens[4], *tokens[5]};
 
   struct Parsed_Statement stmt;
   p_stmt_init(&stmt, STMT_DATA_DECL, 45);
@@ -380,8 +416,8 @@ void test_grammar_identifier_dw_dup_uninit() {
   tokens[4] = create_test_token(TOKEN_RPAREN, ")", 50);
   tokens[5] = create_test_token(TOKEN_EOF, "", 50);
 
-  const struct Token *const_tokens[6] = {tokens[0], tokens[1], tokens[2],
-                                         tokens[3], tokens[4], tokens[5]};
+  const struct Token const_tokens[6] = {*tokens[0], *tokens[1], *tokens[2],
+                                         *tokens[3], *tokens[4], *tokens[5]};
 
   struct Parsed_Statement stmt;
   p_stmt_init(&stmt, STMT_DATA_DECL, 50);
@@ -410,7 +446,7 @@ void test_grammar_identifier_db_dec_string() {
   tokens[0] = create_test_token(TOKEN_STRING, "Hello", 55);
   tokens[1] = create_test_token(TOKEN_EOF, "", 55);
 
-  const struct Token *const_tokens[2] = {tokens[0], tokens[1]};
+  const struct Token const_tokens[2] = {*tokens[0], *tokens[1]};
 
   struct Parsed_Statement stmt;
   p_stmt_init(&stmt, STMT_DATA_DECL, 55);
@@ -420,7 +456,9 @@ void test_grammar_identifier_db_dec_string() {
 
   assert(result == GRM_MATCH);
   assert(stmt.content.data_decl.segments[0].type == INIT_SEG_STRING);
-  assert(strcmp(stmt.content.data_decl.segments[0].data.string, "Hello") == 0);
+  assert(stmt.content.data_decl.segments[0].data.string.len == 5);
+  assert(memcmp(stmt.content.data_decl.segments[0].data.string.text, "Hello",
+                5) == 0);
 
   p_stmt_deinit(&stmt);
   cleanup_tokens(tokens, 2);
@@ -437,7 +475,7 @@ void test_grammar_identifier_db_dec_number() {
   tokens[0] = create_test_token(TOKEN_NUMBER, "65", 60);
   tokens[1] = create_test_token(TOKEN_EOF, "", 60);
 
-  const struct Token *const_tokens[2] = {tokens[0], tokens[1]};
+  const struct Token const_tokens[2] = {*tokens[0], *tokens[1]};
 
   struct Parsed_Statement stmt;
   p_stmt_init(&stmt, STMT_DATA_DECL, 60);
@@ -464,7 +502,7 @@ void test_grammar_line_instruction_no_operands() {
   tokens[0] = create_test_token(TOKEN_INSTRUCTION, "RET", 65);
   tokens[1] = create_test_token(TOKEN_EOF, "", 65);
 
-  const struct Token *const_tokens[2] = {tokens[0], tokens[1]};
+  const struct Token const_tokens[2] = {*tokens[0], *tokens[1]};
 
   struct Parsed_Statement stmt;
   p_stmt_init(&stmt, STMT_INSTRUCTION, 65);
@@ -490,7 +528,7 @@ void test_grammar_instruction_rhs_register() {
   tokens[0] = create_test_token(TOKEN_REGISTER, "A", 70);
   tokens[1] = create_test_token(TOKEN_EOF, "", 70);
 
-  const struct Token *const_tokens[2] = {tokens[0], tokens[1]};
+  const struct Token const_tokens[2] = {*tokens[0], *tokens[1]};
 
   struct Parsed_Statement stmt;
   p_stmt_init(&stmt, STMT_INSTRUCTION, 70);
@@ -499,8 +537,7 @@ void test_grammar_instruction_rhs_register() {
 
   assert(result == GRM_MATCH);
   assert(stmt.content.instruction.operand_count == 1);
-  assert(strcmp(stmt.content.instruction.operands[0].value.register_name,
-                "A") == 0);
+  assert(stmt.content.instruction.operands[0].value.reg == REG_A);
 
   p_stmt_deinit(&stmt);
   cleanup_tokens(tokens, 2);
@@ -517,7 +554,7 @@ void test_grammar_instruction_rhs_number() {
   tokens[0] = create_test_token(TOKEN_NUMBER, "100", 75);
   tokens[1] = create_test_token(TOKEN_EOF, "", 75);
 
-  const struct Token *const_tokens[2] = {tokens[0], tokens[1]};
+  const struct Token const_tokens[2] = {*tokens[0], *tokens[1]};
 
   struct Parsed_Statement stmt;
   p_stmt_init(&stmt, STMT_INSTRUCTION, 75);
@@ -541,9 +578,10 @@ void test_grammar_instruction_rhs_label() {
   // @loop
   struct Token *tokens[2];
   tokens[0] = create_test_token(TOKEN_LABEL, "@loop", 80);
+  tokens[0]->id = 7; // as if interned by lexer
   tokens[1] = create_test_token(TOKEN_EOF, "", 80);
 
-  const struct Token *const_tokens[2] = {tokens[0], tokens[1]};
+  const struct Token const_tokens[2] = {*tokens[0], *tokens[1]};
 
   struct Parsed_Statement stmt;
   p_stmt_init(&stmt, STMT_INSTRUCTION, 80);
@@ -569,7 +607,7 @@ void test_grammar_instruction_rhs_after_register() {
   tokens[0] = create_test_token(TOKEN_REGISTER, "B", 85);
   tokens[1] = create_test_token(TOKEN_EOF, "", 85);
 
-  const struct Token *const_tokens[2] = {tokens[0], tokens[1]};
+  const struct Token const_tokens[2] = {*tokens[0], *tokens[1]};
 
   struct Parsed_Statement stmt;
   p_stmt_init(&stmt, STMT_INSTRUCTION, 85);
@@ -579,8 +617,7 @@ void test_grammar_instruction_rhs_after_register() {
 
   assert(result == GRM_MATCH);
   assert(stmt.content.instruction.operand_count == 2);
-  assert(strcmp(stmt.content.instruction.operands[1].value.register_name,
-                "B") == 0);
+  assert(stmt.content.instruction.operands[1].value.reg == REG_B);
 
   p_stmt_deinit(&stmt);
   cleanup_tokens(tokens, 2);
@@ -597,7 +634,7 @@ void test_grammar_instruction_rhs_after_number() {
   tokens[0] = create_test_token(TOKEN_NUMBER, "200", 90);
   tokens[1] = create_test_token(TOKEN_EOF, "", 90);
 
-  const struct Token *const_tokens[2] = {tokens[0], tokens[1]};
+  const struct Token const_tokens[2] = {*tokens[0], *tokens[1]};
 
   struct Parsed_Statement stmt;
   p_stmt_init(&stmt, STMT_INSTRUCTION, 90);
@@ -623,9 +660,10 @@ void test_grammar_instruction_rhs_after_offset() {
   struct Token *tokens[3];
   tokens[0] = create_test_token(TOKEN_OFFSET, "OFFSET", 95);
   tokens[1] = create_test_token(TOKEN_IDENTIFIER, "myvar", 95);
+  tokens[1]->id = 5; // as if interned by lexer
   tokens[2] = create_test_token(TOKEN_EOF, "", 95);
 
-  const struct Token *const_tokens[3] = {tokens[0], tokens[1], tokens[2]};
+  const struct Token const_tokens[3] = {*tokens[0], *tokens[1], *tokens[2]};
 
   struct Parsed_Statement stmt;
   p_stmt_init(&stmt, STMT_INSTRUCTION, 95);
@@ -636,8 +674,7 @@ void test_grammar_instruction_rhs_after_offset() {
   assert(result == GRM_MATCH);
   assert(stmt.content.instruction.operand_count == 2);
   assert(stmt.content.instruction.operands[1].specifier == OPS_OFFSET);
-  assert(strcmp(stmt.content.instruction.operands[1].value.label, "myvar") ==
-         0);
+  assert(stmt.content.instruction.operands[1].value.symbol_id == 5);
 
   p_stmt_deinit(&stmt);
   cleanup_tokens(tokens, 3);
@@ -654,7 +691,7 @@ void test_grammar_error_handling() {
   tokens[0] = create_test_token(TOKEN_COMMA, ",", 100);
   tokens[1] = create_test_token(TOKEN_EOF, "", 100);
 
-  const struct Token *const_tokens[2] = {tokens[0], tokens[1]};
+  const struct Token const_tokens[2] = {*tokens[0], *tokens[1]};
 
   struct Parsed_Statement stmt;
   p_stmt_init(&stmt, STMT_NONE, 100);
@@ -678,6 +715,55 @@ void test_grammar_error_handling() {
   printf("  PASSED\n");
 }
 
+// Test: only a register may be followed by the second operand
+void test_grammar_instruction_rhs_comma_after_number() {
+  printf("Running test_grammar_instruction_rhs_comma_after_number...\n");
+
+  // 5, A
+  struct Token *tokens[4];
+  tokens[0] = create_test_token(TOKEN_NUMBER, "5", 95);
+  tokens[1] = create_test_token(TOKEN_COMMA, ",", 95);
+  tokens[2] = create_test_token(TOKEN_REGISTER, "A", 95);
+  tokens[3] = create_test_token(TOKEN_EOF, "", 95);
+
+  const struct Token const_tokens[4] = {*tokens[0], *tokens[1], *tokens[2],
+                                        *tokens[3]};
+
+  struct Parsed_Statement stmt;
+  p_stmt_init(&stmt, STMT_INSTRUCTION, 95);
+
+  enum Err_Grm result = grammar_instruction_rhs(&stmt, const_tokens);
+
+  assert(result == GRM_NO_MATCH);
+
+  p_stmt_deinit(&stmt);
+  cleanup_tokens(tokens, 4);
+
+  printf("  PASSED\n");
+}
+
+// Test: grammar_line dispatches by the first token, no line starts by comma
+void test_grammar_line_dispatch_no_match() {
+  printf("Running test_grammar_line_dispatch_no_match...\n");
+
+  struct Token *tokens[3];
+  tokens[0] = create_test_token(TOKEN_COMMA, ",", 96);
+  tokens[1] = create_test_token(TOKEN_REGISTER, "A", 96);
+  tokens[2] = create_test_token(TOKEN_EOF, "", 96);
+
+  const struct Token const_tokens[3] = {*tokens[0], *tokens[1], *tokens[2]};
+
+  struct Parsed_Statement stmt;
+  p_stmt_init(&stmt, STMT_NONE, 96);
+
+  assert(grammar_line(&stmt, const_tokens) == GRM_NO_MATCH);
+
+  p_stmt_deinit(&stmt);
+  cleanup_tokens(tokens, 3);
+
+  printf("  PASSED\n");
+}
+
 int main(void) {
   printf("=== Running Parser Grammar Tests ===\n\n");
 
@@ -689,6 +775,7 @@ int main(void) {
   test_grammar_line_data_match();
   test_grammar_line_label_match();
   test_grammar_line_label_various_names();
+  test_grammar_line_not_interned();
   test_grammar_line_identifier_dword();
   test_grammar_line_identifier_byte();
   test_grammar_identifier_dw_dec_single();
@@ -705,6 +792,8 @@ int main(void) {
   test_grammar_instruction_rhs_after_number();
   test_grammar_instruction_rhs_after_offset();
   test_grammar_error_handling();
+  test_grammar_instruction_rhs_comma_after_number();
+  test_grammar_line_dispatch_no_match();
 
   printf("\n=== All Grammar Tests Passed! ===\n");
   return 0;
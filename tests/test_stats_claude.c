@@ -0,0 +1,254 @@
+#include "../src/memory.h"
+#include "../src/stats.h"
+#include <assert.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Test framework macros */
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name)                                                         \
+  do {                                                                         \
+    printf("Running test: %s\n", #name);                                       \
+    test_##name();                                                             \
+    printf("  PASSED\n");                                                      \
+  } while (0)
+
+/* Print stats in given format into buf, return its length */
+static size_t print_to(const struct Stats *stats, enum Stats_Format format,
+                       char *buf, size_t max) {
+  size_t n = 0;
+  FILE *f = tmpfile();
+  assert(f != NULL);
+  stats_print(stats, format, f);
+  rewind(f);
+  n = fread(buf, 1, max - 1, f);
+  buf[n] = '\0';
+  fclose(f);
+  return n;
+}
+
+/* Stats of a small made up run, every phase took some time */
+static void fill_stats(struct Stats *stats) {
+  size_t i = 0;
+  memset(stats, 0, sizeof(*stats));
+  for (i = 0; i < STATS_PHASE_COUNT; i++) {
+    stats->ns[i] = (uint64_t)(i + 1) * 1000000u; // 1 ms, 2 ms, ...
+  }
+  stats->source_bytes = 2000000;
+  stats->lines = 1000;
+  stats->tokens = 3000;
+  stats->statements = 900;
+  stats->symbols = 42;
+  stats->code_bytes = 4000;
+  stats->data_bytes = 16;
+}
+
+/* ==================== MINIMAL JSON CHECKER ==================== */
+
+static const char *json_value(const char *p);
+
+static const char *json_ws(const char *p) {
+  while (*p == ' ' || *p == '\n' || *p == '\t' || *p == '\r') {
+    p++;
+  }
+  return p;
+}
+
+static const char *json_string(const char *p) {
+  if (*p != '"') {
+    return NULL;
+  }
+  for (p++; *p && *p != '"'; p++) {
+    if (*p == '\\' && *++p == '\0') {
+      return NULL;
+    }
+  }
+  return *p == '"' ? p + 1 : NULL;
+}
+
+static const char *json_number(const char *p) {
+  const char *start = NULL;
+  if (*p == '-') {
+    p++;
+  }
+  start = p;
+  while (isdigit((unsigned char)*p)) {
+    p++;
+  }
+  if (p == start) {
+    return NULL;
+  }
+  if (*p == '.') {
+    start = ++p;
+    while (isdigit((unsigned char)*p)) {
+      p++;
+    }
+    if (p == start) {
+      return NULL;
+    }
+  }
+  return p;
+}
+
+static const char *json_object(const char *p) {
+  p = json_ws(p + 1);
+  if (*p == '}') {
+    return p + 1;
+  }
+  for (;;) {
+    p = json_string(json_ws(p));
+    if (!p || *(p = json_ws(p)) != ':') {
+      return NULL;
+    }
+    p = json_value(p + 1);
+    if (!p) {
+      return NULL;
+    }
+    p = json_ws(p);
+    if (*p == '}') {
+      return p + 1;
+    }
+    if (*p != ',') {
+      return NULL;
+    }
+    p++;
+  }
+}
+
+/* Only what stats_print can produce: objects, strings & numbers */
+static const char *json_value(const char *p) {
+  p = json_ws(p);
+  if (*p == '{') {
+    return json_object(p);
+  }
+  if (*p == '"') {
+    return json_string(p);
+  }
+  return json_number(p);
+}
+
+static int json_valid(const char *text) {
+  const char *end = json_value(text);
+  return end && *json_ws(end) == '\0';
+}
+
+/* ==================== STATS TESTS ==================== */
+
+TEST(json_checker_rejects_broken) {
+  /* The checker itself must tell broken JSON apart */
+  assert(json_valid("{\"a\": 1, \"b\": {\"c\": 2.50}}\n"));
+  assert(!json_valid("{\"a\": 1,}"));
+  assert(!json_valid("{\"a\" 1}"));
+  assert(!json_valid("{\"a\": 1}}"));
+  assert(!json_valid("{\"a\": 1"));
+}
+
+TEST(json_output_shape) {
+  /* One line of valid JSON, with every counter and phase */
+  static const char *const keys[] = {
+      "\"source_bytes\": 2000000", "\"lines\": 1000",
+      "\"tokens\": 3000",          "\"statements\": 900",
+      "\"symbols\": 42",           "\"code_bytes\": 4000",
+      "\"data_bytes\": 16",        "\"total_ns\": ",
+      "\"phases\": {",             "\"read\": {\"ns\": 1000000, ",
+      "\"lex\": {",                "\"parse\": {",
+      "\"pass1\": {",              "\"program\": {",
+      "\"encode\": {",             "\"fixups\": {",
+      "\"output\": {",             "\"lines_per_sec\": 1000000, ",
+      "\"mb_per_sec\": 2000.000",
+  };
+  struct Stats stats;
+  char buf[4096];
+  size_t i = 0, n = 0;
+  fill_stats(&stats);
+
+  n = print_to(&stats, STATS_JSON, buf, sizeof(buf));
+  assert(n > 0 && n < sizeof(buf) - 1);
+  assert(json_valid(buf));
+  assert(buf[n - 1] == '\n' && strchr(buf, '\n') == buf + n - 1);
+  for (i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+    assert(strstr(buf, keys[i]) != NULL);
+  }
+}
+
+TEST(text_output_shape) {
+  /* Counters, header, one row per phase and the total */
+  static const char *const rows[] = {"read ", "lex ",    "parse ",
+                                     "pass1 ", "program ", "encode ",
+                                     "fixups ", "output ", "total "};
+  struct Stats stats;
+  char buf[4096];
+  const char *line = NULL;
+  size_t i = 0, lines = 0;
+  fill_stats(&stats);
+
+  assert(print_to(&stats, STATS_TEXT, buf, sizeof(buf)) > 0);
+  assert(strncmp(buf,
+                 "Stats: 2000000 bytes, 1000 lines, 3000 tokens, "
+                 "900 statements, 42 symbols\n",
+                 71) == 0);
+  assert(strstr(buf, "code 4000 bytes, data 16 bytes\n") != NULL);
+  assert(strstr(buf, "phase") && strstr(buf, "lines/s") &&
+         strstr(buf, "MB/s"));
+  for (line = buf; *line; line++) {
+    lines += *line == '\n';
+  }
+  assert(lines == 3 + STATS_PHASE_COUNT + 1);
+
+  // rows come in order of phases, read took 1 ms for 1000 lines & 2 MB
+  line = buf;
+  for (i = 0; i < sizeof(rows) / sizeof(rows[0]); i++) {
+    line = strstr(line, rows[i]);
+    assert(line != NULL);
+  }
+  assert(strstr(buf, "1.000        1000000    2000.00") != NULL);
+}
+
+TEST(off_prints_nothing) {
+  /* STATS_OFF and NULL stats print nothing at all */
+  struct Stats stats;
+  char buf[64];
+  fill_stats(&stats);
+
+  assert(print_to(&stats, STATS_OFF, buf, sizeof(buf)) == 0);
+  assert(print_to(NULL, STATS_JSON, buf, sizeof(buf)) == 0);
+}
+
+TEST(lap_adds_to_phase) {
+  /* Laps add up in their phase and return the time to continue from */
+  struct Stats stats;
+  uint64_t t = 0;
+  memset(&stats, 0, sizeof(stats));
+
+  t = stats_now();
+  assert(t > 0);
+  t = stats_lap(&stats, STATS_LEX, t);
+  t = stats_lap(&stats, STATS_LEX, t);
+  assert(stats_lap(&stats, STATS_PARSE, t) >= t);
+  assert(stats.ns[STATS_READ] == 0 && stats.ns[STATS_OUTPUT] == 0);
+
+  // start in the future doesn't go negative
+  assert(stats_lap(&stats, STATS_READ, UINT64_MAX) > 0);
+  assert(stats.ns[STATS_READ] == 0);
+}
+
+int main(void) {
+  printf("========================================\n");
+  printf("Running Stats Test Suite\n");
+  printf("========================================\n\n");
+
+  RUN_TEST(json_checker_rejects_broken);
+  RUN_TEST(json_output_shape);
+  RUN_TEST(text_output_shape);
+  RUN_TEST(off_prints_nothing);
+  RUN_TEST(lap_adds_to_phase);
+
+  printf("\n========================================\n");
+  printf("All tests passed!\n");
+  printf("========================================\n");
+
+  assert(jemory() == 0);
+  return 0;
+}
@@ -1,6 +1,7 @@
 #include "../src/memory.h"
 #include "../src/symbol.h"
 #include <assert.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -33,7 +34,7 @@ int main(void) {
   struct Symbol *symC = symtab_add(table, "END", 0x0100);
 
   assert(symA && symB && symC);
-  assert(strcmp(symA->name, "START") == 0);
+  assert(strcmp(symtab_name(table, symA), "START") == 0);
   assert(symB->address == 0x0080);
   assert(table->count == 3);
   printf("✅ Added three symbols successfully.\n");
@@ -44,7 +45,7 @@ int main(void) {
   struct Symbol *foundB = symtab_find(table, "END");
   struct Symbol *foundX = symtab_find(table, "UNKNOWN");
 
-  assert(foundA && strcmp(foundA->name, "START") == 0);
+  assert(foundA && strcmp(symtab_name(table, foundA), "START") == 0);
   assert(foundB && foundB->address == 0x0100);
   assert(foundX == NULL);
   printf("✅ Symbol lookup works correctly.\n");
@@ -55,7 +56,44 @@ int main(void) {
   assert(symtab_add(table, NULL, 1) == NULL);
   printf("✅ Invalid add tests passed.\n");
 
-  // === Test 5: Memory cleanup ===
+  // === Test 5: Unique insertion and growth ===
+  TEST("symtab_insert_unique()");
+  int inserted = -1;
+  struct Symbol *uniq =
+      symtab_insert_unique(table, "START", 0x9999, SYM_DATA, &inserted);
+  assert(uniq && inserted == 0 && uniq->address == 0x0040); // kept original
+
+  char name[32];
+  for (int i = 0; i < 5000; i++) {
+    snprintf(name, sizeof(name), "@label%d", i);
+    uniq = symtab_insert_unique(table, name, (uint32_t)i, SYM_LABEL,
+                                &inserted);
+    assert(uniq && inserted == 1);
+  }
+  assert(table->count == 5003);
+  assert(table->index_capacity >= table->count * SYMTAB_INDEX_MULT);
+  for (int i = 0; i < 5000; i += 7) {
+    snprintf(name, sizeof(name), "@label%d", i);
+    struct Symbol *found = symtab_find(table, name);
+    assert(found && found->address == (uint32_t)i);
+  }
+  assert(symtab_find(table, "@label5000") == NULL);
+  assert(symtab_find(table, "LOOP")->address == 0x0080); // survived rehash
+  struct Symbol *lbl = symtab_find(table, "@label42");
+  assert(lbl && lbl->kind == SYM_LABEL && lbl->name_len == 8);
+  assert(strcmp(symtab_name(table, lbl), "@label42") == 0);
+
+  // names are not limited in length
+  char long_name[1000];
+  memset(long_name, 'n', sizeof(long_name) - 1);
+  long_name[sizeof(long_name) - 1] = '\0';
+  uniq = symtab_insert_unique(table, long_name, 7, SYM_DATA, &inserted);
+  assert(uniq && inserted == 1);
+  assert(strcmp(symtab_name(table, symtab_find(table, long_name)),
+                long_name) == 0);
+  printf("✅ Unique insertion tests passed.\n");
+
+  // === Test 6: Memory cleanup ===
   TEST("symtab_free()");
   symtab_free(&table);
   assert(table == NULL);